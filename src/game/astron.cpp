@@ -740,6 +740,43 @@ void astron::recalc_palette()
     palette_modified = false;
 }
 
+bool astron::load_roms()
+{
+    bool result = game::load_roms();
+
+    if (result) decode_characters();
+
+    return result;
+}
+
+// Runs every character through the bank prom up front, for both settings of
+// the bank bit (0xd801 bit 5), so repaint() doesn't have to.
+void astron::decode_characters()
+{
+    m_char_tiles.create(0x200, 8, 8);
+
+    for (int bank = 0; bank < 2; bank++) {
+        for (int code = 0; code < 0x100; code++) {
+            Uint8 *tile = m_char_tiles.get_tile((bank << 8) | code);
+
+            for (int y = 0; y < 8; y++) {
+                Uint8 lo = character[code * 8 + y];
+                Uint8 hi = character[code * 8 + y + 0x800];
+
+                for (int x = 0; x < 8; x++) {
+                    int bit = 7 - x;
+                    tile[y * 8 + x] =
+                        bankprom[((lo >> bit) & 0x01) | (((hi >> bit) & 0x01) << 1) |
+                                 ((code & 0xf8) >> 0x01) | (bank << 7)];
+                }
+            }
+        }
+    }
+
+    m_char_tiles.finalize();
+    m_char_map.create(&m_char_tiles, 32, 32, 8, 8);
+}
+
 // updates astron's video
 void astron::repaint()
 {
@@ -761,82 +798,20 @@ void astron::repaint()
     }
     // END modified Mame code
 
-    Uint8 pixel[8];
+    // the characters go on top
+    unsigned int bank = (m_cpumem[0xd801] & 0x20) ? 0x100 : 0;
 
-    // loop through video memory and draw characters
     for (int charx = 0; charx < 32; charx++) {
         for (int chary = 0; chary < 32; chary++) {
-            for (int y = 0; y < 8; y++) {
-                int current_character = chary * 32 + charx + BASE_VID_MEM_ADDRESS;
-
-                pixel[0] = static_cast<Uint8>(
-                    bankprom[((character[m_cpumem[current_character] * 8 + y] & 0x80) >> 7) |
-                             ((character[m_cpumem[current_character] * 8 + y + 0x800] & 0x80) >> 6) |
-                             (((m_cpumem[current_character]) & 0xf8) >> 0x01) |
-                             ((m_cpumem[0xd801] & 0x20) << 2)]);
-                pixel[1] = static_cast<Uint8>(
-                    bankprom[((character[m_cpumem[current_character] * 8 + y] & 0x40) >> 6) |
-                             ((character[m_cpumem[current_character] * 8 + y + 0x800] & 0x40) >> 5) |
-                             (((m_cpumem[current_character]) & 0xf8) >> 0x01) |
-                             ((m_cpumem[0xd801] & 0x20) << 2)]);
-                pixel[2] = static_cast<Uint8>(
-                    bankprom[((character[m_cpumem[current_character] * 8 + y] & 0x20) >> 5) |
-                             ((character[m_cpumem[current_character] * 8 + y + 0x800] & 0x20) >> 4) |
-                             (((m_cpumem[current_character]) & 0xf8) >> 0x01) |
-                             ((m_cpumem[0xd801] & 0x20) << 2)]);
-                pixel[3] = static_cast<Uint8>(
-                    bankprom[((character[m_cpumem[current_character] * 8 + y] & 0x10) >> 4) |
-                             ((character[m_cpumem[current_character] * 8 + y + 0x800] & 0x10) >> 3) |
-                             (((m_cpumem[current_character]) & 0xf8) >> 0x01) |
-                             ((m_cpumem[0xd801] & 0x20) << 2)]);
-                pixel[4] = static_cast<Uint8>(
-                    bankprom[((character[m_cpumem[current_character] * 8 + y] & 0x08) >> 3) |
-                             ((character[m_cpumem[current_character] * 8 + y + 0x800] & 0x08) >> 2) |
-                             (((m_cpumem[current_character]) & 0xf8) >> 0x01) |
-                             ((m_cpumem[0xd801] & 0x20) << 2)]);
-                pixel[5] = static_cast<Uint8>(
-                    bankprom[((character[m_cpumem[current_character] * 8 + y] & 0x04) >> 2) |
-                             ((character[m_cpumem[current_character] * 8 + y + 0x800] & 0x04) >> 1) |
-                             (((m_cpumem[current_character]) & 0xf8) >> 0x01) |
-                             ((m_cpumem[0xd801] & 0x20) << 2)]);
-                pixel[6] = static_cast<Uint8>(
-                    bankprom[((character[m_cpumem[current_character] * 8 + y] & 0x02) >> 1) |
-                             ((character[m_cpumem[current_character] * 8 + y + 0x800] & 0x02) >> 0) |
-                             (((m_cpumem[current_character]) & 0xf8) >> 0x01) |
-                             ((m_cpumem[0xd801] & 0x20) << 2)]);
-                pixel[7] = static_cast<Uint8>(
-                    bankprom[((character[m_cpumem[current_character] * 8 + y] & 0x01) >> 0) |
-                             ((character[m_cpumem[current_character] * 8 + y + 0x800] & 0x01) << 1) |
-                             (((m_cpumem[current_character]) & 0xf8) >> 0x01) |
-                             ((m_cpumem[0xd801] & 0x20) << 2)]);
-
-                // draw the remapped colors instead of the regular if our
-                // palette is compressed
-                if (compress_palette) {
-                    for (int x = 0; x < 8; x++) {
-                        if (pixel[x]) {
-                            *((Uint8 *)m_video_overlay[m_active_video_overlay]->pixels +
-                              ((chary * 8 + y) * ASTRON_OVERLAY_W) +
-                              (charx * 8 + x)) = mapped_tile_color[pixel[x]];
-
-                            // char s[81] = {0};
-                            // sprintf(s, "drawing color %x",
-                            // mapped_tile_color[pixel[x]]);
-                            // printline(s);
-                        }
-                    }
-                } else {
-                    for (int x = 0; x < 8; x++) {
-                        if (pixel[x]) {
-                            *((Uint8 *)m_video_overlay[m_active_video_overlay]->pixels +
-                              ((chary * 8 + y) * ASTRON_OVERLAY_W) +
-                              (charx * 8 + x)) = pixel[x];
-                        }
-                    }
-                }
-            }
+            m_char_map.set(charx, chary,
+                           m_cpumem[chary * 32 + charx + BASE_VID_MEM_ADDRESS] + bank);
         }
     }
+
+    // draw the remapped colors instead of the regular if our palette is
+    // compressed
+    m_char_map.draw(m_video_overlay[m_active_video_overlay],
+                    compress_palette ? mapped_tile_color : NULL);
 }
 
 // this gets called when the user presses a key or moves the joystick
@@ -26,6 +26,7 @@
 #define ASTRON_H
 
 #include "game.h"
+#include "../video/tilemap.h"
 
 #define ASTRON_OVERLAY_W 256 // width of overlay
 #define ASTRON_OVERLAY_H 256 // height of overlay
@@ -81,6 +82,7 @@ class astron : public game
     virtual void input_disable(Uint8);
     void repaint(); // function to repaint video
     void palette_calculate();
+    bool load_roms();
     bool set_bank(Uint8, Uint8);
     virtual void write_ldp(Uint8, Uint16);
     virtual Uint8 read_ldp(Uint16);
@@ -89,6 +91,7 @@ class astron : public game
     int current_bank;
     void recalc_palette();
     void draw_sprite(int);
+    void decode_characters();
     Uint8 rombank[0x8000];
     Uint8 character[0x1000];
     Uint8 sprite[0x10000];
@@ -101,6 +104,8 @@ class astron : public game
                            // surface?
     bool used_sprite_color[256];
     Uint8 mapped_tile_color[256];
+    tileset m_char_tiles; // characters with bankprom applied, both banks
+    tilemap m_char_map;
     Uint8 ldp_output_latch; // holds data to be sent to the LDV1000
     Uint8 ldp_input_latch;  // holds data that was retrieved from the LDV1000
 
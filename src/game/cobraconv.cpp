@@ -404,30 +404,32 @@ void cobraconv::repaint()
     SDL_FillRect(m_video_overlay[m_active_video_overlay], NULL, 0);
 
     // draw sprites first(?)
-    draw_sprites(0x2800, character2);
+    draw_sprites(0x2800);
+
+    // this is a decent guess about the color selection
+    Uint8 color = static_cast<Uint8>(8 * ((m_cpumem[0x1001] >> 4) & 3));
 
     // draw tiles
     for (int charx = 0; charx < 32; charx++) {
         // don't draw the first line of tiles (this is where the sprite data is)
         for (int chary = 1; chary < 32; chary++) {
-            // draw 8x8 tiles from tile/sprite generator 2
-            int current_character = m_cpumem[chary * 32 + charx + 0x2800] +
-                                    256 * (m_cpumem[chary * 32 + charx + 0x2c00] & 0x03);
-            draw_8x8(current_character, character2, charx * 8, chary * 8, 0, 0,
-                     (m_cpumem[0x1001] >> 4) & 3); // this is a decent guess
-                                                   // about the color selection
-
-            // draw 8x8 tiles from tile/sprite generator 1
-            current_character = m_cpumem[chary * 32 + charx + 0x2000] +
-                                256 * (m_cpumem[chary * 32 + charx + 0x2400] & 0x03);
-            draw_8x8(current_character, character2,
-                     // charx*8, chary*8,  // x/y swapped vs Bega's Battle
-                     // hardware
-                     chary * 8, charx * 8, 0, 0,
-                     (m_cpumem[0x1001] >> 4) & 3); // this is a decent guess
-                                                   // about the color selection
+            // 8x8 tiles from tile/sprite generator 2
+            m_char_map2.set(charx, chary,
+                            m_cpumem[chary * 32 + charx + 0x2800] +
+                                256 * (m_cpumem[chary * 32 + charx + 0x2c00] & 0x03),
+                            color);
+
+            // 8x8 tiles from tile/sprite generator 1
+            // (x/y swapped vs Bega's Battle hardware)
+            m_char_map1.set(chary, charx,
+                            m_cpumem[chary * 32 + charx + 0x2000] +
+                                256 * (m_cpumem[chary * 32 + charx + 0x2400] & 0x03),
+                            color);
         }
     }
+
+    m_char_map2.draw(m_video_overlay[m_active_video_overlay]);
+    m_char_map1.draw(m_video_overlay[m_active_video_overlay]);
 }
 
 // used to set dip switch values
@@ -576,104 +578,72 @@ void cobraconv::OnLDV1000LineChange(bool bIsStatus, bool bIsEnabled)
     }
 }
 
-void cobraconv::draw_8x8(int character_number, Uint8 *character_set, int xcoord,
-                         int ycoord, int xflip, int yflip, int color)
+bool cobraconv::load_roms()
 {
-    Uint8 pixel[8] = {0};
-
-    for (int y = 0; y < 8; y++) {
-        Uint8 byte1 = character_set[character_number * 8 + y];
-        Uint8 byte2 = character_set[character_number * 8 + y + 0x2000];
-        Uint8 byte3 = character_set[character_number * 8 + y + 0x4000];
-
-        pixel[0] = static_cast<Uint8>(((byte1 & 0x01) << 2) | ((byte2 & 0x01) << 1) |
-                                      ((byte3 & 0x01) << 0));
-        pixel[1] = static_cast<Uint8>(((byte1 & 0x02) << 1) | ((byte2 & 0x02) << 0) |
-                                      ((byte3 & 0x02) >> 1));
-        pixel[2] = static_cast<Uint8>(((byte1 & 0x04) << 0) | ((byte2 & 0x04) >> 1) |
-                                      ((byte3 & 0x04) >> 2));
-        pixel[3] = static_cast<Uint8>(((byte1 & 0x08) >> 1) | ((byte2 & 0x08) >> 2) |
-                                      ((byte3 & 0x08) >> 3));
-        pixel[4] = static_cast<Uint8>(((byte1 & 0x10) >> 2) | ((byte2 & 0x10) >> 3) |
-                                      ((byte3 & 0x10) >> 4));
-        pixel[5] = static_cast<Uint8>(((byte1 & 0x20) >> 3) | ((byte2 & 0x20) >> 4) |
-                                      ((byte3 & 0x20) >> 5));
-        pixel[6] = static_cast<Uint8>(((byte1 & 0x40) >> 4) | ((byte2 & 0x40) >> 5) |
-                                      ((byte3 & 0x40) >> 6));
-        pixel[7] = static_cast<Uint8>(((byte1 & 0x80) >> 5) | ((byte2 & 0x80) >> 6) |
-                                      ((byte3 & 0x80) >> 7));
-
-        for (int x = 0; x < 8; x++) {
-            if (pixel[x]) {
-                *((Uint8 *)m_video_overlay[m_active_video_overlay]->pixels +
-                  ((ycoord + (yflip ? y : (7 - y))) * COBRACONV_OVERLAY_W) +
-                  (xcoord + (xflip ? (7 - x) : x))) = pixel[x] + (8 * color);
-            }
-        }
-    }
+    bool result = game::load_roms();
+
+    if (result) decode_graphics();
+
+    return result;
 }
 
-void cobraconv::draw_16x32(int character_number, Uint8 *character_set, int xcoord,
-                           int ycoord, int xflip, int yflip, int color)
+void cobraconv::decode_graphics()
 {
-    Uint8 pixel[16] = {0};
+    // 3 bitplanes 0x2000 apart, least significant bit on the left, stored
+    // bottom row first
+    m_char_tiles.create(0x400, 8, 8);
+
+    for (int code = 0; code < 0x400; code++) {
+        Uint8 *tile = m_char_tiles.get_tile(code);
 
-    for (int b = 0; b < 8; b += 2) // laid out as four 8-pixel high blocks
-    {
         for (int y = 0; y < 8; y++) {
-            Uint8 byte1 = character_set[character_number * 32 + y + (b * 8)];
-            Uint8 byte2 = character_set[character_number * 32 + y + 0x2000 + (b * 8)];
-            Uint8 byte3 = character_set[character_number * 32 + y + 0x4000 + (b * 8)];
-            Uint8 byte4 = character_set[character_number * 32 + y + ((b + 1) * 8)];
-            Uint8 byte5 =
-                character_set[character_number * 32 + y + 0x2000 + ((b + 1) * 8)];
-            Uint8 byte6 =
-                character_set[character_number * 32 + y + 0x4000 + ((b + 1) * 8)];
-
-            pixel[0] = static_cast<Uint8>(
-                (((byte1 & 0x01) << 2) | ((byte2 & 0x01) << 1) | ((byte3 & 0x01) << 0)));
-            pixel[1] = static_cast<Uint8>(
-                (((byte1 & 0x02) << 1) | ((byte2 & 0x02) << 0) | ((byte3 & 0x02) >> 1)));
-            pixel[2] = static_cast<Uint8>(
-                (((byte1 & 0x04) << 0) | ((byte2 & 0x04) >> 1) | ((byte3 & 0x04) >> 2)));
-            pixel[3] = static_cast<Uint8>(
-                (((byte1 & 0x08) >> 1) | ((byte2 & 0x08) >> 2) | ((byte3 & 0x08) >> 3)));
-            pixel[4] = static_cast<Uint8>(
-                (((byte1 & 0x10) >> 2) | ((byte2 & 0x10) >> 3) | ((byte3 & 0x10) >> 4)));
-            pixel[5] = static_cast<Uint8>(
-                (((byte1 & 0x20) >> 3) | ((byte2 & 0x20) >> 4) | ((byte3 & 0x20) >> 5)));
-            pixel[6] = static_cast<Uint8>(
-                (((byte1 & 0x40) >> 4) | ((byte2 & 0x40) >> 5) | ((byte3 & 0x40) >> 6)));
-            pixel[7] = static_cast<Uint8>(
-                (((byte1 & 0x80) >> 5) | ((byte2 & 0x80) >> 6) | ((byte3 & 0x80) >> 7)));
-            pixel[8] = static_cast<Uint8>(
-                (((byte4 & 0x01) << 2) | ((byte5 & 0x01) << 1) | ((byte6 & 0x01) << 0)));
-            pixel[9] = static_cast<Uint8>(
-                (((byte4 & 0x02) << 1) | ((byte5 & 0x02) << 0) | ((byte6 & 0x02) >> 1)));
-            pixel[10] = static_cast<Uint8>(
-                (((byte4 & 0x04) << 0) | ((byte5 & 0x04) >> 1) | ((byte6 & 0x04) >> 2)));
-            pixel[11] = static_cast<Uint8>(
-                (((byte4 & 0x08) >> 1) | ((byte5 & 0x08) >> 2) | ((byte6 & 0x08) >> 3)));
-            pixel[12] = static_cast<Uint8>(
-                (((byte4 & 0x10) >> 2) | ((byte5 & 0x10) >> 3) | ((byte6 & 0x10) >> 4)));
-            pixel[13] = static_cast<Uint8>(
-                (((byte4 & 0x20) >> 3) | ((byte5 & 0x20) >> 4) | ((byte6 & 0x20) >> 5)));
-            pixel[14] = static_cast<Uint8>(
-                (((byte4 & 0x40) >> 4) | ((byte5 & 0x40) >> 5) | ((byte6 & 0x40) >> 6)));
-            pixel[15] = static_cast<Uint8>(
-                (((byte4 & 0x80) >> 5) | ((byte5 & 0x80) >> 6) | ((byte6 & 0x80) >> 7)));
-
-            for (int x = 0; x < 16; x++) {
-                if (pixel[x]) {
-                    *((Uint8 *)m_video_overlay[m_active_video_overlay]->pixels +
-                      ((ycoord + (8 - y) + (b * 4)) * COBRACONV_OVERLAY_W) +
-                      (xcoord + (xflip ? (15 - x) : x))) = pixel[x] + (8 * color);
+            Uint8 byte1 = character2[code * 8 + y];
+            Uint8 byte2 = character2[code * 8 + y + 0x2000];
+            Uint8 byte3 = character2[code * 8 + y + 0x4000];
+
+            for (int x = 0; x < 8; x++) {
+                tile[(7 - y) * 8 + x] = static_cast<Uint8>((((byte1 >> x) & 0x01) << 2) |
+                                                           (((byte2 >> x) & 0x01) << 1) |
+                                                           ((byte3 >> x) & 0x01));
+            }
+        }
+    }
+
+    m_char_tiles.finalize();
+    m_char_map1.create(&m_char_tiles, 32, 32, 8, 8);
+    m_char_map2.create(&m_char_tiles, 32, 32, 8, 8);
+
+    // sprites are laid out as four 8-pixel high blocks, each one being a
+    // pair of characters side by side, again bottom row first
+    m_sprite_tiles.create(0x100, 16, 32);
+
+    for (int num = 0; num < 0x100; num++) {
+        Uint8 *tile = m_sprite_tiles.get_tile(num);
+
+        for (int b = 0; b < 8; b += 2) {
+            for (int y = 0; y < 8; y++) {
+                Uint8 *row = tile + ((b * 4) + (7 - y)) * 16;
+
+                for (int half = 0; half < 2; half++) {
+                    int src     = num * 32 + y + ((b + half) * 8);
+                    Uint8 byte1 = character2[src];
+                    Uint8 byte2 = character2[src + 0x2000];
+                    Uint8 byte3 = character2[src + 0x4000];
+
+                    for (int x = 0; x < 8; x++) {
+                        row[half * 8 + x] = static_cast<Uint8>((((byte1 >> x) & 0x01) << 2) |
+                                                               (((byte2 >> x) & 0x01) << 1) |
+                                                               ((byte3 >> x) & 0x01));
+                    }
                 }
             }
         }
     }
+
+    m_sprite_tiles.finalize();
 }
-void cobraconv::draw_sprites(int offset, Uint8 *character_set)
+
+void cobraconv::draw_sprites(int offset)
 {
     for (int sprites = 0; sprites < 0x32; sprites += 4) {
         if ((m_cpumem[offset + sprites] & 0x01) && (m_cpumem[offset + sprites + 3] < 240)) {
@@ -683,11 +653,13 @@ void cobraconv::draw_sprites(int offset, Uint8 *character_set)
             //				m_cpumem[offset + sprites + 3], m_cpumem[offset + sprites
             //+ 2]);
             //			printline(s);
-            draw_16x32(m_cpumem[offset + sprites + 1], character_set,
-                       m_cpumem[offset + sprites + 3], m_cpumem[offset + sprites + 2],
-                       m_cpumem[offset + sprites] & 0x04, m_cpumem[offset + sprites] & 0x02,
-                       0); // this isn't the correct color... i'm not sure where
-                           // color comes from right now
+            // the sprite's rows start one line below its y coordinate
+            m_sprite_tiles.draw(m_video_overlay[m_active_video_overlay],
+                                m_cpumem[offset + sprites + 1], m_cpumem[offset + sprites + 3],
+                                m_cpumem[offset + sprites + 2] + 1,
+                                (m_cpumem[offset + sprites] & 0x04) ? TILE_XFLIP : 0,
+                                0); // this isn't the correct color... i'm not sure where
+                                    // color comes from right now
         }
     }
 }
@@ -24,6 +24,7 @@
 // by Warren Ondras, based on bega.h by Mark Broadhead
 
 #include "game.h"
+#include "../video/tilemap.h"
 
 #define COBRACONV_OVERLAY_W 256 // width of overlay
 #define COBRACONV_OVERLAY_H 256 // height of overlay
@@ -44,6 +45,7 @@ class cobraconv : public game
     void OnVblank();
     void OnLDV1000LineChange(bool bIsStatus, bool bIsEnabled);
     void palette_calculate();
+    bool load_roms();
     void repaint(); // function to repaint video
     bool set_bank(unsigned char, unsigned char);
 
@@ -52,9 +54,8 @@ class cobraconv : public game
     Uint8 m_soundchip_id;
     Uint8 m_soundchip_address_latch;
     Uint8 m_cpumem2[0x10000]; // 64k of space for the sound cpu
-    void draw_8x8(int, Uint8 *, int, int, int, int, int);
-    void draw_16x32(int, Uint8 *, int, int, int, int, int);
-    void draw_sprites(int, Uint8 *);
+    void decode_graphics();
+    void draw_sprites(int);
     Uint8 ldp_status;
     Uint8 character1[0x6000];
     Uint8 character2[0x6000];
@@ -63,6 +64,11 @@ class cobraconv : public game
     Uint8 miscprom[0x400]; // stores unused proms, to make sure no one strips
                            // them out
 
+    tileset m_char_tiles;   // from character2
+    tileset m_sprite_tiles; // 16x32, also from character2
+    tilemap m_char_map1;    // tile/sprite generator 1 (0x2000)
+    tilemap m_char_map2;    // tile/sprite generator 2 (0x2800)
+
     bool palette_updated; // whether our color ram has been written to
     Uint8 banks[4];       // switch banks
                           // bank 0 is switches
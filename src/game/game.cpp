@@ -495,7 +495,7 @@ void game::blit()
 
         // MAC: No software scaling to be done on SDL2, so we just update the texture here,
         // and SDL_RenderCopy() will hw-scale for us.
-        video::vid_update_overlay_surface(m_video_overlay[m_active_video_overlay], 0, 0);
+        video::vid_update_overlay_surface(get_blit_overlay(), 0, 0);
         m_finished_video_overlay = m_active_video_overlay;
     }
     video::vid_blit();
@@ -918,6 +918,11 @@ SDL_Surface *game::get_active_video_overlay()
     return m_video_overlay[m_active_video_overlay];
 }
 
+SDL_Surface *game::get_blit_overlay()
+{
+    return m_video_overlay[m_active_video_overlay];
+}
+
 // gets last surface to be completely drawn (so it can be displayed without
 // worrying about tearing or flickering)
 SDL_Surface *game::get_finished_video_overlay()
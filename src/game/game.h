@@ -212,6 +212,10 @@ class game
     SDL_Surface *get_active_video_overlay(); // returns the current active video
                                              // overlay (that is currently being
                                              // drawn)
+    // the surface blit() hands to the video code once repaint() is done:
+    // the active overlay, unless the game draws somewhere else (Singe draws
+    // in 32-bit)
+    virtual SDL_Surface *get_blit_overlay();
     SDL_Surface *get_finished_video_overlay(); // returns the last complete
                                                // video overlay (that isn't
                                                // currently being drawn)
@@ -447,7 +447,7 @@ void gpworld::recalc_palette()
                     palette::set_color(k, palette_lookup[color]);
 
                     used_tile_colors[color] = k;
-                    tile_color_pointer[i]   = k;
+                    tile_color_pointer[i]   = static_cast<Uint8>(k);
                     k++;
                     if (k > 255) {
                         printline("Too many tile colors! FIX ME!");
@@ -465,6 +465,44 @@ void gpworld::recalc_palette()
     palette_modified = false;
 }
 
+bool gpworld::load_roms()
+{
+    bool result = game::load_roms();
+
+    if (result) decode_characters();
+
+    return result;
+}
+
+// Decodes the 2bpp characters once.  The upper bits of the character number
+// pick its colors, so those get baked in; tile_color_pointer is applied when
+// the characters are drawn since the color ram can change.
+void gpworld::decode_characters()
+{
+    m_char_tiles.create(0x100, 8, 8);
+
+    for (int code = 0; code < 0x100; code++) {
+        Uint8 *tile = m_char_tiles.get_tile(code);
+
+        for (int y = 0; y < 8; y++) {
+            Uint8 lo = character[code * 8 + y];
+            Uint8 hi = character[code * 8 + y + 0x800];
+
+            for (int x = 0; x < 8; x++) {
+                int bit     = 7 - x;
+                Uint8 pixel = static_cast<Uint8>(((lo >> bit) & 0x01) | (((hi >> bit) & 0x01) << 1));
+                tile[y * 8 + x] = pixel ? (pixel | (code & 0xfc)) : 0;
+            }
+        }
+    }
+
+    m_char_tiles.finalize();
+
+    // the characters are 8 pixels wide but only 7 apart, the ones on the right
+    // overlapping the ones on the left
+    m_char_map.create(&m_char_tiles, 64 - 19, 32, 7, 8, 5, 0);
+}
+
 // updates gpworld's video
 void gpworld::repaint()
 {
@@ -487,51 +525,15 @@ void gpworld::repaint()
     }
     // END modified Mame code
 
-    Uint8 pixel[8];
-    Uint8 p = 5;
-
     // loop through video memory and draw characters
     for (int charx = 19; charx < 64; charx++) {
         for (int chary = 0; chary < 32; chary++) {
-            for (int y = 0; y < 8; y++) {
-                int current_character = chary * 64 + charx + GPWORLD_VID_ADDRESS;
-
-                pixel[0] = static_cast<Uint8>(
-                    ((character[m_cpumem[current_character] * 8 + y] & 0x80) >> 7) |
-                    ((character[m_cpumem[current_character] * 8 + y + 0x800] & 0x80) >> 6));
-                pixel[1] = static_cast<Uint8>(
-                    ((character[m_cpumem[current_character] * 8 + y] & 0x40) >> 6) |
-                    ((character[m_cpumem[current_character] * 8 + y + 0x800] & 0x40) >> 5));
-                pixel[2] = static_cast<Uint8>(
-                    ((character[m_cpumem[current_character] * 8 + y] & 0x20) >> 5) |
-                    ((character[m_cpumem[current_character] * 8 + y + 0x800] & 0x20) >> 4));
-                pixel[3] = static_cast<Uint8>(
-                    ((character[m_cpumem[current_character] * 8 + y] & 0x10) >> 4) |
-                    ((character[m_cpumem[current_character] * 8 + y + 0x800] & 0x10) >> 3));
-                pixel[4] = static_cast<Uint8>(
-                    ((character[m_cpumem[current_character] * 8 + y] & 0x08) >> 3) |
-                    ((character[m_cpumem[current_character] * 8 + y + 0x800] & 0x08) >> 2));
-                pixel[5] = static_cast<Uint8>(
-                    ((character[m_cpumem[current_character] * 8 + y] & 0x04) >> 2) |
-                    ((character[m_cpumem[current_character] * 8 + y + 0x800] & 0x04) >> 1));
-                pixel[6] = static_cast<Uint8>(
-                    ((character[m_cpumem[current_character] * 8 + y] & 0x02) >> 1) |
-                    ((character[m_cpumem[current_character] * 8 + y + 0x800] & 0x02) >> 0));
-                pixel[7] = static_cast<Uint8>(
-                    ((character[m_cpumem[current_character] * 8 + y] & 0x01) >> 0) |
-                    ((character[m_cpumem[current_character] * 8 + y + 0x800] & 0x01) << 1));
-
-                for (int x = 0; x < 8; x++) {
-                    if (pixel[x]) {
-                        *((Uint8 *)m_video_overlay[m_active_video_overlay]->pixels +
-                          ((chary * 8 + y) * GPWORLD_OVERLAY_W) + ((charx - 19) * 7 + x + p)) =
-                            tile_color_pointer[(pixel[x]) | ((m_cpumem[current_character]) & 0xfc)];
-                    }
-                }
-            }
+            m_char_map.set(charx - 19, chary, m_cpumem[chary * 64 + charx + GPWORLD_VID_ADDRESS]);
         }
     }
 
+    m_char_map.draw(m_video_overlay[m_active_video_overlay], tile_color_pointer);
+
     // test - make an 8x8 block of every color
     //		for (x = 0; x < 256; x++)
     //		{
@@ -26,6 +26,7 @@
 #define GPWORLD_H
 
 #include "game.h"
+#include "../video/tilemap.h"
 
 #define GPWORLD_OVERLAY_W 360 // width of overlay
 #define GPWORLD_OVERLAY_H 256 // height of overlay
@@ -61,6 +62,7 @@ class gpworld : public game
     virtual void input_disable(Uint8);
     bool set_bank(Uint8, Uint8);
     void palette_calculate();
+    bool load_roms();
     void repaint(); // function to repaint video
     virtual void write_ldp(Uint8, Uint16);
     virtual Uint8 read_ldp(Uint16);
@@ -68,12 +70,15 @@ class gpworld : public game
   protected:
     void recalc_palette();
     void draw_sprite(int);
+    void decode_characters();
     Uint8 rombank[0x8000];
     Uint8 character[0x1000];
     Uint8 sprite[0x30000];
     Uint8 miscprom[0x220];
     SDL_Color palette_lookup[4096]; // all possible color entries
-    int tile_color_pointer[256];
+    Uint8 tile_color_pointer[256];
+    tileset m_char_tiles; // characters with their color bits, before mapping
+    tilemap m_char_map;
     Uint8 m_transparent_color; // which color is to be transparent
     bool palette_modified;     // has our palette been modified?
     Uint8 ldp_output_latch;    // holds data to be sent to the LDV1000
@@ -645,9 +645,12 @@ void interstellar::repaint()
 
         if ((m_cpumem[sprite_data + 1] != 0xff) && (m_cpumem[sprite_data + 3] != 0xff) &&
             (((~m_cpumem[sprite_data + 0]) & 0xff) != 0xff)) {
-            draw_16x16(m_cpumem[sprite_data + 1], m_cpumem[sprite_data + 3],
-                       240 - m_cpumem[sprite_data + 0], m_cpumem[sprite_data + 2] & 0x40,
-                       m_cpumem[sprite_data + 2] & 0x80, m_cpumem[sprite_data + 2] & 0x0f);
+            Uint8 attr = m_cpumem[sprite_data + 2];
+            m_sprite_tiles.draw(m_video_overlay[m_active_video_overlay],
+                                m_cpumem[sprite_data + 1], m_cpumem[sprite_data + 3],
+                                240 - m_cpumem[sprite_data + 0],
+                                ((attr & 0x40) ? TILE_XFLIP : 0) | ((attr & 0x80) ? TILE_YFLIP : 0),
+                                static_cast<Uint8>((attr & 0x0f) << 3));
         }
     }
 
@@ -661,9 +664,11 @@ void interstellar::repaint()
             int palette      = (m_cpumem[(chary << 5) + charx + 0xac00] & 0x0f);
             int current_char = (m_cpumem[(chary << 5) + charx + 0xa800]);
 
-            draw_8x8(current_char, charx * 8, chary * 8, 0, 0, palette);
+            m_char_map.set(charx, chary, current_char, static_cast<Uint8>(palette << 3));
         }
     }
+
+    m_char_map.draw(m_video_overlay[m_active_video_overlay]);
 }
 
 // this gets called when the user presses a key or moves the joystick
@@ -779,55 +784,56 @@ bool interstellar::set_bank(Uint8 which_bank, Uint8 value)
     return result;
 }
 
-void interstellar::draw_8x8(int character_number, int xcoord, int ycoord,
-                            int xflip, int yflip, int palette)
+bool interstellar::load_roms()
+{
+    bool result = game::load_roms();
+
+    if (result) decode_graphics();
+
+    return result;
+}
+
+void interstellar::decode_graphics()
 {
-    Uint8 pixel[8] = {0};
-
-    for (int y = 0; y < 8; y++) {
-        if ((y + ycoord) < INTERSTELLAR_OVERLAY_H) {
-            Uint8 byte3 = character[character_number * 8 + y];
-            Uint8 byte2 = character[character_number * 8 + y + 0x2000];
-            Uint8 byte1 = character[character_number * 8 + y + 0x4000];
-
-            pixel[0] = static_cast<Uint8>(((byte1 & 0x80) >> 5) | ((byte2 & 0x80) >> 6) |
-                                          ((byte3 & 0x80) >> 7));
-            pixel[1] = static_cast<Uint8>(((byte1 & 0x40) >> 4) | ((byte2 & 0x40) >> 5) |
-                                          ((byte3 & 0x40) >> 6));
-            pixel[2] = static_cast<Uint8>(((byte1 & 0x20) >> 3) | ((byte2 & 0x20) >> 4) |
-                                          ((byte3 & 0x20) >> 5));
-            pixel[3] = static_cast<Uint8>(((byte1 & 0x10) >> 2) | ((byte2 & 0x10) >> 3) |
-                                          ((byte3 & 0x10) >> 4));
-            pixel[4] = static_cast<Uint8>(((byte1 & 0x08) >> 1) | ((byte2 & 0x08) >> 2) |
-                                          ((byte3 & 0x08) >> 3));
-            pixel[5] = static_cast<Uint8>(((byte1 & 0x04) << 0) | ((byte2 & 0x04) >> 1) |
-                                          ((byte3 & 0x04) >> 2));
-            pixel[6] = static_cast<Uint8>(((byte1 & 0x02) << 1) | ((byte2 & 0x02) << 0) |
-                                          ((byte3 & 0x02) >> 1));
-            pixel[7] = static_cast<Uint8>(((byte1 & 0x01) << 2) | ((byte2 & 0x01) << 1) |
-                                          ((byte3 & 0x01) << 0));
+    // 3 bitplanes, 0x2000 apart
+    m_char_tiles.create(0x400, 8, 8);
+
+    for (int code = 0; code < 0x400; code++) {
+        Uint8 *tile = m_char_tiles.get_tile(code);
+
+        for (int y = 0; y < 8; y++) {
+            Uint8 byte3 = character[code * 8 + y];
+            Uint8 byte2 = character[code * 8 + y + 0x2000];
+            Uint8 byte1 = character[code * 8 + y + 0x4000];
 
             for (int x = 0; x < 8; x++) {
-                if ((pixel[x]) && ((x + xcoord) < INTERSTELLAR_OVERLAY_W)) {
-                    *((Uint8 *)m_video_overlay[m_active_video_overlay]->pixels +
-                      ((ycoord + (yflip ? (7 - y) : y)) * INTERSTELLAR_OVERLAY_W) +
-                      (xcoord + (xflip ? (7 - x) : x))) =
-                        (Uint8)(pixel[x] | (palette << 3));
-                }
+                int bit         = 7 - x;
+                tile[y * 8 + x] = static_cast<Uint8>((((byte1 >> bit) & 0x01) << 2) |
+                                                     (((byte2 >> bit) & 0x01) << 1) |
+                                                     ((byte3 >> bit) & 0x01));
             }
         }
     }
-}
 
-void interstellar::draw_16x16(int character_number, int xcoord, int ycoord,
-                              int xflip, int yflip, int palette)
-{
-    draw_8x8((character_number * 4) + 0, xcoord + (xflip ? 8 : 0),
-             ycoord + (yflip ? 8 : 0), xflip, yflip, palette);
-    draw_8x8((character_number * 4) + 1, xcoord + (xflip ? 0 : 8),
-             ycoord + (yflip ? 8 : 0), xflip, yflip, palette);
-    draw_8x8((character_number * 4) + 2, xcoord + (xflip ? 8 : 0),
-             ycoord + (yflip ? 0 : 8), xflip, yflip, palette);
-    draw_8x8((character_number * 4) + 3, xcoord + (xflip ? 0 : 8),
-             ycoord + (yflip ? 0 : 8), xflip, yflip, palette);
+    m_char_tiles.finalize();
+    m_char_map.create(&m_char_tiles, 32, 32, 8, 8);
+
+    // Sprites (256 16x16 sprites, uses the same data as the 8x8 characters)
+    // are 4 characters: top left, top right, bottom left, bottom right
+    m_sprite_tiles.create(0x100, 16, 16);
+
+    for (int num = 0; num < 0x100; num++) {
+        Uint8 *tile = m_sprite_tiles.get_tile(num);
+
+        for (int quarter = 0; quarter < 4; quarter++) {
+            const Uint8 *src = m_char_tiles.get_tile(num * 4 + quarter);
+            Uint8 *dst       = tile + ((quarter & 2) ? 8 * 16 : 0) + ((quarter & 1) ? 8 : 0);
+
+            for (int y = 0; y < 8; y++) {
+                memcpy(dst + y * 16, src + y * 8, 8);
+            }
+        }
+    }
+
+    m_sprite_tiles.finalize();
 }
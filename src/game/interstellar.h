@@ -26,6 +26,7 @@
 #define INTERSTELLAR_H
 
 #include "game.h"
+#include "../video/tilemap.h"
 
 #define INTERSTELLAR_OVERLAY_W 256 // width of overlay
 #define INTERSTELLAR_OVERLAY_H 256 // height of overlay
@@ -47,6 +48,7 @@ class interstellar : public game
     void input_enable(Uint8);
     void input_disable(Uint8);
     void palette_calculate();
+    bool load_roms();
     void repaint(); // function to repaint video
     bool set_bank(Uint8, Uint8);
 
@@ -66,10 +68,10 @@ class interstellar : public game
     Uint8 cpu_latch2;
     Uint8 sound_latch;
     bool sound_data;
-    void draw_8x8(int character_number, int xcoord, int ycoord, int xflip,
-                  int yflip, int palette);
-    void draw_16x16(int character_number, int xcoord, int ycoord, int xflip,
-                    int yflip, int palette);
+    void decode_graphics();
+    tileset m_char_tiles;
+    tileset m_sprite_tiles; // 16x16, made of four characters each
+    tilemap m_char_map;
 };
 
 #endif
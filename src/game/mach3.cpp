@@ -1122,23 +1122,22 @@ void mach3::draw_characters()
     for (int charx = 0; charx < 32; charx++) {
         for (int chary = 0; chary < 30; chary++) {
             // draw 8x8 tiles from character generator
-            int current_character = m_cpumem[chary * 32 + charx + 0x3800];
-            draw_8x8(current_character, character, charx * 8, chary * 8);
+            m_char_map.set(charx, chary, m_cpumem[chary * 32 + charx + 0x3800]);
         }
     }
+
+    m_char_map.draw(m_video_overlay[m_active_video_overlay]);
 }
 
 void mach3::draw_sprites()
 {
-    Uint16 offset = 0x0000; // uvt has two banks
+    unsigned int bank = 0x000; // uvt has two banks
 
     if ((m_cpumem[0x5803] & 0x02)) // bank select bit
     {
-        offset = 0x2000;
+        bank = 0x100;
     }
 
-    Uint8 *spritebank = (Uint8 *)&sprite[offset];
-
     // docs say 63 sprites, each 16x16
     for (int spritenum = 0; spritenum < 62; spritenum++) {
         Uint8 *pSpriteInfo = &m_cpumem[0x3000 + spritenum * 4];
@@ -1161,7 +1160,11 @@ void mach3::draw_sprites()
             // WDO: not sure why characters need to be accessed in reverse order
             Uint8 current_character =
                 255 - static_cast<Uint8>((uSpriteInfo & 0x00FF0000) >> 16);
-            draw_16x16(current_character, spritebank, xpos, ypos);
+            // sprites are offset from tiles (so they can be partially
+            // off-screen); used cobram3 ROM to align - cockpit has tiles and
+            // sprites that should line up
+            m_sprite_tiles.draw(m_video_overlay[m_active_video_overlay],
+                                bank + current_character, xpos - 4, ypos - 13, 0);
         }
     }
 
@@ -1171,109 +1174,63 @@ void mach3::draw_sprites()
     {
     for (int y = 0; y < 256; y+=16)
     {
-    draw_16x16(snum++, spritebank, x, y);
+    m_sprite_tiles.draw(m_video_overlay[m_active_video_overlay], bank + snum++, x, y, 0);
     }
     } */
 }
 
-void mach3::draw_8x8(Uint8 character_number, Uint8 *character_set, Uint8 xcoord, Uint8 ycoord)
+bool mach3::load_roms()
 {
-    Uint8 pixel[8] = {0};
-
-    //	static Uint8 tmpchar = 0;  // test hack to show the whole character set
-    //  character_number =  tmpchar++;
-
-    for (int y = 0; y < 8; y++) {
-        // characters are contiguous blocks of 4-bpp values (32 bytes total for
-        // each 8x8 char)
-        pixel[0] = static_cast<Uint8>(
-            (character_set[(character_number * 32) + 0 + (y * 4)] & 0xF0) >> 4);
-        pixel[1] = static_cast<Uint8>(
-            (character_set[(character_number * 32) + 0 + (y * 4)] & 0x0F) >> 0);
-        pixel[2] = static_cast<Uint8>(
-            (character_set[(character_number * 32) + 1 + (y * 4)] & 0xF0) >> 4);
-        pixel[3] = static_cast<Uint8>(
-            (character_set[(character_number * 32) + 1 + (y * 4)] & 0x0F) >> 0);
-        pixel[4] = static_cast<Uint8>(
-            (character_set[(character_number * 32) + 2 + (y * 4)] & 0xF0) >> 4);
-        pixel[5] = static_cast<Uint8>(
-            (character_set[(character_number * 32) + 2 + (y * 4)] & 0x0F) >> 0);
-        pixel[6] = static_cast<Uint8>(
-            (character_set[(character_number * 32) + 3 + (y * 4)] & 0xF0) >> 4);
-        pixel[7] = static_cast<Uint8>(
-            (character_set[(character_number * 32) + 3 + (y * 4)] & 0x0F) >> 0);
-
-        for (int x = 0; x < 8; x++) {
-            if (pixel[x]) {
-                *((Uint8 *)m_video_overlay[m_active_video_overlay]->pixels +
-                  ((ycoord + y) * MACH3_OVERLAY_W) + (xcoord + x)) = pixel[x];
-            }
-        }
-    }
+    bool result = game::load_roms();
+
+    if (result) decode_graphics();
+
+    return result;
 }
 
-void mach3::draw_16x16(Uint8 character_number, Uint8 *character_set, Uint8 xpos, Uint8 ypos)
+void mach3::decode_graphics()
 {
-    Uint8 pixel[16] = {0};
-
-    Uint8 xmin = 0, xmax = 16, ymin = 0, ymax = 16;
+    // characters are contiguous blocks of 4-bpp values (32 bytes total for
+    // each 8x8 char)
+    m_char_tiles.create(0x100, 8, 8);
 
-    int ycoord = ypos - 13; // sprites are offset from tiles (so they can be
-                            // partially off-screen)
-    int xcoord = xpos - 4;  // used cobram3 ROM to align - cockpit has tiles and
-                            // sprites that should line up
+    for (int code = 0; code < 0x100; code++) {
+        Uint8 *tile = m_char_tiles.get_tile(code);
 
-    if (xcoord < 0) {
-        xmin = -xcoord;
-    }
-    if (xcoord > MACH3_OVERLAY_W - 16) {
-        if (xcoord >= MACH3_OVERLAY_W) {
-            xmax = xmin; // don't draw at all if it's somewhere completely off
-                         // the screen
-        } else {
-            xmax = MACH3_OVERLAY_W - xcoord; // draw the visible portion
+        for (int i = 0; i < 32; i++) {
+            tile[i * 2 + 0] = static_cast<Uint8>(character[code * 32 + i] >> 4);
+            tile[i * 2 + 1] = static_cast<Uint8>(character[code * 32 + i] & 0x0F);
         }
     }
 
-    if (ycoord < 0) {
-        ymin = -ycoord;
-    }
-    if (ycoord > MACH3_OVERLAY_H - 16) {
-        if (ycoord >= MACH3_OVERLAY_H) {
-            ymax = ymin; // don't draw at all if it's somewhere completely off
-                         // the screen
-        } else {
-            ymax = MACH3_OVERLAY_H - ycoord; // draw the visible portion
-        }
-    }
+    m_char_tiles.finalize();
+    m_char_map.create(&m_char_tiles, 32, 30, 8, 8);
 
-    for (int y = ymin; y < ymax; y++) {
+    // sprites are in blocks of 16-pixel lines x 16 rows, across 4 bitplanes
+    // (32 bytes in each bitplane for each 16x16 char); the second bank starts
+    // 0x2000 into each bitplane
+    m_sprite_tiles.create(0x200, 16, 16);
 
-        Uint8 *current_line = &character_set[character_number * 32 + (y * 2)];
+    for (int num = 0; num < 0x200; num++) {
+        Uint8 *tile = m_sprite_tiles.get_tile(num);
 
-        // characters are in blocks of 16-pixel lines x 16 rows, across 4
-        // bitplanes (32 bytes in each bitplane for each 16x16 char)
-        for (int i = 7; i >= 0; i--) {
-            pixel[15 - (i + 8)] = static_cast<Uint8>(
-                (((*(current_line + 0 + 0x0000) >> (i)) & 0x01) << 3) +
-                (((*(current_line + 0 + 0x4000) >> (i)) & 0x01) << 2) +
-                (((*(current_line + 0 + 0x8000) >> (i)) & 0x01) << 1) +
-                (((*(current_line + 0 + 0xC000) >> (i)) & 0x01) << 0));
+        for (int y = 0; y < 16; y++) {
+            Uint8 *current_line = &sprite[num * 32 + (y * 2)];
 
-            pixel[15 - i] = static_cast<Uint8>(
-                (((*(current_line + 1 + 0x0000) >> (i)) & 0x01) << 3) +
-                (((*(current_line + 1 + 0x4000) >> (i)) & 0x01) << 2) +
-                (((*(current_line + 1 + 0x8000) >> (i)) & 0x01) << 1) +
-                (((*(current_line + 1 + 0xC000) >> (i)) & 0x01) << 0));
-        }
+            for (int x = 0; x < 16; x++) {
+                int byte = x >> 3;
+                int bit  = 7 - (x & 7);
 
-        for (int x = xmin; x < xmax; x++) {
-            if (pixel[x]) {
-                *((Uint8 *)m_video_overlay[m_active_video_overlay]->pixels +
-                  ((ycoord + y) * MACH3_OVERLAY_W) + (xcoord + x)) = pixel[x];
+                tile[y * 16 + x] = static_cast<Uint8>(
+                    (((*(current_line + byte + 0x0000) >> bit) & 0x01) << 3) |
+                    (((*(current_line + byte + 0x4000) >> bit) & 0x01) << 2) |
+                    (((*(current_line + byte + 0x8000) >> bit) & 0x01) << 1) |
+                    (((*(current_line + byte + 0xC000) >> bit) & 0x01) << 0));
             }
         }
     }
+
+    m_sprite_tiles.finalize();
 }
 
 // to help with debugging
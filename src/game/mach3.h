@@ -26,6 +26,7 @@
 #define MACH3_H
 
 #include "game.h"
+#include "../video/tilemap.h"
 
 #include <queue> // for testing, can be replaced with array later
 
@@ -64,6 +65,7 @@ class mach3 : public game
     //	void set_version(int);
     //	bool handle_cmdline_arg(const char *arg);
     void patch_roms();
+    bool load_roms();
     Uint8 character[0x2000]; // character gfx ROM (8KB)
     Uint8 sprite[0x10000]; // sprite gfx ROM (64KB for UVT, 32KB for MACH3)
     Uint8 m_cpumem2[0x10000]; // memory space for first 6502
@@ -89,8 +91,11 @@ class mach3 : public game
     void draw_characters();
     void draw_sprites();
 
-    void draw_8x8(Uint8 character_number, Uint8 *character_set, Uint8 xcoord, Uint8 ycoord);
-    void draw_16x16(Uint8 character_number, Uint8 *character_set, Uint8 xcoord, Uint8 ycoord);
+    void decode_graphics();
+
+    tileset m_char_tiles;
+    tileset m_sprite_tiles; // both sprite banks, 0x100 sprites each
+    tilemap m_char_map;
 
     Uint8 m_frame_decoder_select_bit;
     Uint8 m_audio_ready_bit;
@@ -62,6 +62,7 @@ const unsigned int REL_COLOR_COUNT = 256;
 releasetest::releasetest()
     : m_test_all(true), // run all tests by default
       m_test_line_parse(false), m_test_framefile_parse(false), m_test_rgb2yuv(false),
+      m_test_rgb2yuv_buf(false),
       m_test_think_delay(false), m_test_vldp(false),
       m_test_vldp_render(false), m_test_mix(false),
       m_test_samples(false), m_test_sound_mixing(false)
@@ -103,6 +104,7 @@ void releasetest::start()
     if (dotest(m_test_line_parse)) test_line_parse();
     if (dotest(m_test_framefile_parse)) test_framefile_parse();
     if (dotest(m_test_samples)) test_samples();
+    if (dotest(m_test_rgb2yuv_buf)) test_rgb2yuv_buf();
 
 // Only test these functions if we've built with MMX code,
 //  otherwise the test is useless
@@ -399,6 +401,111 @@ void releasetest::test_rgb2yuv()
     logtest(passed, "RGB2YUV Complete Exerciser");
 }
 
+void releasetest::test_rgb2yuv_buf()
+{
+    const unsigned int CHUNK = 1 << 16; // one red value's worth of colors
+    const unsigned int PIXELS = REL_VID_W * REL_VID_H;
+    const unsigned int FRAMES = 500;
+    bool passed = true;
+#ifdef USE_MMX
+    const int PREC = 1; // the assembly rgb2yuv() is allowed to drift
+#else
+    const int PREC = 0;
+#endif
+
+    printline("Beginning batch RGB2YUV exerciser ...");
+
+    vector<Uint8> rgbx(CHUNK * 4);
+    vector<Uint8> y_c(CHUNK), u_c(CHUNK), v_c(CHUNK);
+    vector<Uint8> y_s(CHUNK), u_s(CHUNK), v_s(CHUNK);
+
+    // every color there is, in chunks
+    for (unsigned int r = 0; (r <= 255) && passed && (!get_quitflag()); r++) {
+        for (unsigned int i = 0; i < CHUNK; i++) {
+            rgbx[i * 4]     = r;
+            rgbx[i * 4 + 1] = i >> 8;
+            rgbx[i * 4 + 2] = i & 0xFF;
+            rgbx[i * 4 + 3] = i * 7; // junk, must be ignored
+        }
+
+        rgb2yuv_buf_c(&rgbx[0], &y_c[0], &u_c[0], &v_c[0], CHUNK);
+        rgb2yuv_buf(&rgbx[0], &y_s[0], &u_s[0], &v_s[0], CHUNK);
+
+        for (unsigned int i = 0; i < CHUNK; i++) {
+            // the batch C version has to agree with the existing rgb2yuv() ...
+            rgb2yuv_input[0] = r;
+            rgb2yuv_input[1] = i >> 8;
+            rgb2yuv_input[2] = i & 0xFF;
+            rgb2yuv();
+
+            if ((!i_close_enuf(y_c[i], rgb2yuv_result_y, PREC)) ||
+                (!i_close_enuf(u_c[i], rgb2yuv_result_u, PREC)) ||
+                (!i_close_enuf(v_c[i], rgb2yuv_result_v, PREC))) {
+                string err = "ERROR : RGB(" + numstr::ToStr(r) + "," +
+                             numstr::ToStr(i >> 8) + "," + numstr::ToStr(i & 0xFF) +
+                             ") gives YUV(" + numstr::ToStr(y_c[i]) + "," +
+                             numstr::ToStr(u_c[i]) + "," + numstr::ToStr(v_c[i]) +
+                             ") from rgb2yuv_buf_c, rgb2yuv gives (" +
+                             numstr::ToStr(rgb2yuv_result_y) + "," +
+                             numstr::ToStr(rgb2yuv_result_u) + "," +
+                             numstr::ToStr(rgb2yuv_result_v) + ")";
+                printline(err.c_str());
+                passed = false;
+                break;
+            }
+
+            // ... and the SIMD version with the batch C version, exactly
+            if ((y_c[i] != y_s[i]) || (u_c[i] != u_s[i]) || (v_c[i] != v_s[i])) {
+                string err = "ERROR : RGB(" + numstr::ToStr(r) + "," +
+                             numstr::ToStr(i >> 8) + "," + numstr::ToStr(i & 0xFF) +
+                             ") gives YUV(" + numstr::ToStr(y_s[i]) + "," +
+                             numstr::ToStr(u_s[i]) + "," + numstr::ToStr(v_s[i]) +
+                             "), expected (" + numstr::ToStr(y_c[i]) + "," +
+                             numstr::ToStr(u_c[i]) + "," + numstr::ToStr(v_c[i]) + ")";
+                printline(err.c_str());
+                passed = false;
+                break;
+            }
+        }
+        SDL_check_input(); // give user some breathing room
+    }
+
+    logtest(passed, "Batch RGB2YUV Complete Exerciser");
+
+    if (!passed) return;
+
+    // now time both of them on a full frame
+    rgbx.resize(PIXELS * 4);
+    y_s.resize(PIXELS);
+    u_s.resize(PIXELS);
+    v_s.resize(PIXELS);
+    for (unsigned int i = 0; i < PIXELS * 4; i++) {
+        rgbx[i] = (Uint8)(i * 31);
+    }
+
+    for (int pass = 0; pass < 2; pass++) {
+        unsigned int uStartTime = GET_TICKS();
+
+        for (unsigned int f = 0; f < FRAMES; f++) {
+            if (pass == 0) rgb2yuv_buf_c(&rgbx[0], &y_s[0], &u_s[0], &v_s[0], PIXELS);
+            else rgb2yuv_buf(&rgbx[0], &y_s[0], &u_s[0], &v_s[0], PIXELS);
+        }
+
+        unsigned int uElapsedMs = elapsed_ms_time(uStartTime);
+        if (uElapsedMs == 0) uElapsedMs = 1;
+
+        string msg = (pass == 0) ? "RGB2YUV C    : " : "RGB2YUV batch: ";
+        msg += numstr::ToStr(FRAMES) + " frames of " + numstr::ToStr(REL_VID_W) +
+               "x" + numstr::ToStr(REL_VID_H) + " in " + numstr::ToStr(uElapsedMs) +
+               " ms (" +
+               numstr::ToStr((unsigned int)(((double)PIXELS * FRAMES) /
+                                            (uElapsedMs * 1000.0))) +
+               " Mpixels/s)";
+        printline(msg.c_str());
+        SDL_check_input();
+    }
+}
+
 void releasetest::test_think_delay()
 {
     unsigned int uStartTime = GET_TICKS();
@@ -691,7 +798,7 @@ void releasetest::test_sound_mixing()
     iSlot = samples::play(u8Buf, sizeof(u8Buf), 2, -1, NULL);
     if (iSlot >= 0) {
         // test the sample mixer passed through the main audio mixer
-        sound::callback(NULL, u8Stream, sizeof(u8Stream));
+        sound::mix(u8Stream, sizeof(u8Stream));
 
         // these should be the same ...
         if (memcmp(u8Stream, u8Buf, sizeof(u8Buf)) == 0) {
@@ -707,7 +814,7 @@ void releasetest::test_sound_mixing()
     int iSlot2 = samples::play(u8Buf, sizeof(u8Buf), 2, -1, NULL);
     if ((iSlot >= 0) && (iSlot2 >= 0)) {
         // test the sample mixer passed through the main audio mixer
-        sound::callback(NULL, u8Stream, sizeof(u8Stream));
+        sound::mix(u8Stream, sizeof(u8Stream));
 
         // these should be the same ...
         if (memcmp(u8Stream, u8BufClipped, sizeof(u8Buf)) == 0) {
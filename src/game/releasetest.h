@@ -78,6 +78,10 @@ class releasetest : public game
     void test_rgb2yuv();
     bool m_test_rgb2yuv; // runs rgb2yuv test if true
 
+    // checks rgb2yuv_buf against the C version and times them both
+    void test_rgb2yuv_buf();
+    bool m_test_rgb2yuv_buf;
+
     // tests think_delay function
     void test_think_delay();
     bool m_test_think_delay;
@@ -28,6 +28,9 @@
 
 #include "singe.h"
 #include "singe/singe_interface.h"
+#include "../video/spritebatch.h"
+#include "../io/homedir.h"
+#include <plog/Log.h>
 
 // Win32 doesn't use strcasecmp, it uses stricmp (lame)
 #ifdef WIN32
@@ -56,6 +59,35 @@ static Sint16 xpos, ypos, jrelx, jrely, xmov, ymov;
 static Uint16 js_sen = 5;
 static bool bjx, bjy = false;
 
+// -lua_gc_budget: collect Lua's garbage in whatever time each pass of the
+// loop has left over, instead of whenever Lua decides to
+static bool gc_budget = false;
+static const Uint64 GC_FRAME_US = 30000;
+static const Uint64 GC_SLACK_US = 2000;
+
+// -singe_vsync: run the loop once per display refresh instead of every 30ms
+static bool vsync_pace = false;
+
+// -singe_profile: profile the script, with a report in the logs directory
+static bool profile = false;
+
+// adds the time since 'start' to the profile as 'name'
+static void profile_time(const char *name, Uint64 start)
+{
+    Uint64 us = ((SDL_GetPerformanceCounter() - start) * 1000000) /
+                SDL_GetPerformanceFrequency();
+    g_pSingeOut->sep_profile_time(name, (unsigned int)us);
+}
+
+// what's left of a 'frame_us' long pass that began at 'start', less a little
+// for what still has to be done after the collector's had its go
+static unsigned int gc_time_left(Uint64 start, Uint64 frame_us)
+{
+    Uint64 used = ((SDL_GetPerformanceCounter() - start) * 1000000) /
+                  SDL_GetPerformanceFrequency();
+    return (used < frame_us - GC_SLACK_US) ? (unsigned int)(frame_us - GC_SLACK_US - used) : 0;
+}
+
 bool singe_alt_pressed = false;
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -127,6 +159,11 @@ bool singe::init()
         g_SingeIn.samples_play_sample = samples::play;
         g_SingeIn.set_last_error      = set_last_error;
 
+        // compiled scripts are kept in the homedir
+        static string strCacheDir;
+        strCacheDir         = g_homedir.get_homedir() + "/cache";
+        g_SingeIn.cache_dir = strCacheDir.c_str();
+
         // by RDG2010
         g_SingeIn.get_status        = get_status;
         g_SingeIn.get_singe_version = get_singe_version;
@@ -199,6 +236,11 @@ void singe::start()
     printline(s1);
     g_pSingeOut->sep_set_surface(m_video_overlay_width, m_video_overlay_height);
     g_pSingeOut->sep_set_static_pointers(&m_disc_fps, &m_uDiscFPKS);
+    g_pSingeOut->sep_set_gc_manual(gc_budget);
+    if (profile) {
+        string strReport = g_homedir.get_homedir() + "/logs/singe_profile.txt";
+        g_pSingeOut->sep_set_profile(strReport.c_str());
+    }
     g_pSingeOut->sep_startup(m_strGameScript.c_str());
     g_ldp->set_seek_frames_per_ms(0);
     g_ldp->set_min_seek_delay(0);
@@ -206,8 +248,15 @@ void singe::start()
     // if singe didn't get an error during startup...
     if (!get_quitflag()) {
 
+        // (returns once it's time to quit)
+        if (vsync_pace) {
+            vsync_loop();
+        }
+
         while (!get_quitflag()) {
-            g_pSingeOut->sep_call_lua("onOverlayUpdate", ">i", &intReturn);
+            Uint64 start = SDL_GetPerformanceCounter();
+
+            intReturn = g_pSingeOut->sep_on_overlay_update();
             if (intReturn == 1) {
                 m_video_overlay_needs_update = true;
             }
@@ -216,21 +265,103 @@ void singe::start()
                 JoystickMotion();
             }
 
+            Uint64 blit_start = SDL_GetPerformanceCounter();
             blit();
+            if (profile) profile_time("blit", blit_start);
             SDL_check_input();
             samples::do_queued_callbacks(); // hack to ensure sound callbacks are
                                             // called at a time when lua can
                                             // accept them without crashing
+            if (gc_budget) {
+                g_pSingeOut->sep_gc_step(gc_time_left(start, GC_FRAME_US));
+            }
+            Uint64 think_start = SDL_GetPerformanceCounter();
             g_ldp->think_delay(30);         // don't hog cpu, and advance timer
+            if (profile) profile_time("think_delay", think_start);
         }
 
-        g_pSingeOut->sep_call_lua("onShutdown", "");
+        g_pSingeOut->sep_on_shutdown();
+
+        struct singe_lua_stats stats;
+        g_pSingeOut->sep_get_lua_stats(&stats);
+        LOGI << fmt("Lua heap %uKB (peak %uKB, pool %uKB), %u pooled / %u malloc'd allocations",
+                    stats.uHeapKB, stats.uPeakKB, stats.uPoolKB, stats.uSmallAllocs,
+                    stats.uLargeAllocs);
+        if (gc_budget)
+            LOGI << fmt("Lua GC: %u steps, %u collections (%u forced), %.1fms in all, "
+                        "longest %uus", stats.uGcSteps, stats.uGcCycles, stats.uGcForced,
+                        stats.dGcTotalMs, stats.uGcMaxUs);
     } // end if there was no startup error
 
     // always call sep_shutdown just to make sure everything gets cleaned up
     g_pSingeOut->sep_shutdown();
 }
 
+// -singe_vsync: one pass per display refresh, or per field of the disc when
+// presenting doesn't wait for the refresh.  The laserdisc's clock is moved on
+// by the time that has really gone by, rather than a fixed 30ms.
+void singe::vsync_loop()
+{
+    Uint64 freq     = SDL_GetPerformanceFrequency();
+    bool bWaits     = video::get_blit_waits_vsync();
+    int iHz         = bWaits ? video::get_refresh_rate() : 0;
+    double dRate    = (iHz > 0) ? iHz : ((m_disc_fps > 0) ? m_disc_fps * 2 : 60.0);
+    Uint64 period   = (Uint64)(freq / dRate);
+    Uint64 frame_us = (Uint64)(1000000 / dRate);
+
+    LOGI << fmt("Singe loop paced to the %s, %.2fHz",
+                (iHz > 0) ? "display refresh" : "disc field rate", dRate);
+
+    Uint64 last  = SDL_GetPerformanceCounter();
+    Uint64 next  = last + period;
+    Uint64 carry = 0; // time not yet given to the laserdisc, in counter ticks
+
+    while (!get_quitflag()) {
+        Uint64 start = SDL_GetPerformanceCounter();
+
+        // the script gets to see the freshest input there is
+        SDL_check_input();
+        if (bjx||bjy) {
+            JoystickMotion();
+        }
+
+        if (g_pSingeOut->sep_on_overlay_update() == 1) {
+            m_video_overlay_needs_update = true;
+        }
+
+        // before blit(), which may spend the rest of the frame waiting
+        if (gc_budget) {
+            g_pSingeOut->sep_gc_step(gc_time_left(start, frame_us));
+        }
+
+        Uint64 blit_start = SDL_GetPerformanceCounter();
+        blit();
+        if (profile) profile_time("blit (and vsync)", blit_start);
+        samples::do_queued_callbacks(); // (see start())
+
+        // wait for the next frame ourselves, if presenting didn't (a driver
+        // can ignore vsync, so a pass that took under half a frame didn't)
+        Uint64 now = SDL_GetPerformanceCounter();
+        if (!bWaits || (now - start < period / 2)) {
+            if (now < next) {
+                SDL_Delay((Uint32)(((next - now) * 1000) / freq));
+                now = SDL_GetPerformanceCounter();
+            }
+        }
+        next += period;
+        if (next < now) next = now + period; // fell behind: don't try to catch up
+
+        // move the laserdisc on by the whole milliseconds that have gone by
+        carry += now - last;
+        last = now;
+        unsigned int uMs = (unsigned int)((carry * 1000) / freq);
+        carry -= ((Uint64)uMs * freq) / 1000;
+        Uint64 think_start = SDL_GetPerformanceCounter();
+        g_ldp->think_delay(uMs);
+        if (profile) profile_time("think_delay", think_start);
+    }
+}
+
 void singe::shutdown() {}
 
 void singe::input_enable(Uint8 input)
@@ -259,7 +390,7 @@ void singe::input_enable(Uint8 input)
     }
 
     if (g_pSingeOut) // by RDG2010
-        g_pSingeOut->sep_call_lua("onInputPressed", "i", input);
+        g_pSingeOut->sep_on_input(input, true);
 }
 
 void singe::input_disable(Uint8 input)
@@ -280,7 +411,7 @@ void singe::input_disable(Uint8 input)
     }
 
     if (g_pSingeOut) // by RDG2010
-        g_pSingeOut->sep_call_lua("onInputReleased", "i", input);
+        g_pSingeOut->sep_on_input(input, false);
 }
 
 void singe::OnMouseMotion(Uint16 x, Uint16 y, Sint16 xrel, Sint16 yrel)
@@ -342,6 +473,26 @@ bool singe::handle_cmdline_arg(const char *arg)
         video::set_singe_blend_sprite(true);
         bResult = true;
     }
+    // let the renderer draw the sprites and fonts
+    else if (strcasecmp(arg, "-gpu_sprites") == 0) {
+        spritebatch::set_enabled(true);
+        bResult = true;
+    }
+    // run the loop at the display's (or disc's) rate instead of every 30ms
+    else if (strcasecmp(arg, "-singe_vsync") == 0) {
+        vsync_pace = true;
+        bResult = true;
+    }
+    // count and time what the script does, and write a report at the end
+    else if (strcasecmp(arg, "-singe_profile") == 0) {
+        profile = true;
+        bResult = true;
+    }
+    // run Lua's garbage collector in each frame's spare time
+    else if (strcasecmp(arg, "-lua_gc_budget") == 0) {
+        gc_budget = true;
+        bResult = true;
+    }
     else if (strcasecmp(arg, "-js_range") == 0) {
         get_next_word(s, sizeof(s));
         i = atoi(s);
@@ -412,9 +563,14 @@ void singe::repaint()
         }
     } // end if dimensions are incorrect
 
-    g_pSingeOut->sep_do_blit(m_video_overlay[m_active_video_overlay]);
+    // the sprites drawn since the last repaint are what go on screen now
+    if (spritebatch::is_enabled()) spritebatch::publish();
 }
 
+// Singe's overlay is 32-bit, and the video code takes it as it is (no trip
+// through the 8-bit overlay and the palette)
+SDL_Surface *singe::get_blit_overlay() { return g_pSingeOut->sep_get_surface(); }
+
 void singe::set_last_error(const char *cpszErrMsg)
 {
     // TODO : figure out reliable way to call printerror (maybe there isn't
@@ -58,6 +58,7 @@ class singe : public game
     bool handle_cmdline_arg(const char *arg);
     void palette_calculate();
     void repaint();
+    SDL_Surface *get_blit_overlay();
 
     // g_ldp function wrappers (to make function pointers out of them)
     static void enable_audio1() { g_ldp->enable_audio1(); }
@@ -140,6 +141,9 @@ class singe : public game
     // callback function for singe to pass error messages to us
     static void set_last_error(const char *cpszErrMsg);
 
+    // the main loop, with -singe_vsync
+    void vsync_loop();
+
     string m_strName;       // name of the game
     string m_strGameScript; // script name for the game
 
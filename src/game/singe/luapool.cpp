@@ -0,0 +1,168 @@
+/*
+ * luapool.cpp
+ *
+ * This file is part of HYPSEUS, a laserdisc arcade game emulator
+ *
+ * HYPSEUS is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * HYPSEUS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "luapool.h"
+#include <stdlib.h>
+#include <string.h>
+
+namespace luapool
+{
+static const size_t CLASSES    = MAX_SMALL / GRANULE;
+static const size_t CHUNK_SIZE = 64 * 1024;
+
+// a free block: its first bytes point to the next free block of its size
+struct free_s {
+    free_s *pNext;
+};
+
+// chunks are chained through their first bytes, so they can all be freed
+struct chunk_s {
+    chunk_s *pNext;
+};
+
+struct pool_s {
+    free_s *pFree[CLASSES];
+    chunk_s *pChunks;
+    // where the next block can be carved from in the newest chunk
+    char *pCarve;
+    size_t uCarveLeft;
+    stats_s stats;
+};
+
+// the size class for 'size' bytes (which must be 1..MAX_SMALL)
+static inline size_t class_of(size_t size) { return (size - 1) / GRANULE; }
+
+pool_s *create()
+{
+    pool_s *pPool = (pool_s *)calloc(1, sizeof(pool_s));
+    return pPool;
+}
+
+void destroy(pool_s *pPool)
+{
+    if (!pPool) return;
+
+    chunk_s *pChunk = pPool->pChunks;
+    while (pChunk) {
+        chunk_s *pNext = pChunk->pNext;
+        free(pChunk);
+        pChunk = pNext;
+    }
+    free(pPool);
+}
+
+static void *small_alloc(pool_s *pPool, size_t size)
+{
+    size_t c     = class_of(size);
+    free_s *pBlk = pPool->pFree[c];
+
+    pPool->stats.uSmallAllocs++;
+    if (pBlk) {
+        pPool->pFree[c] = pBlk->pNext;
+        return pBlk;
+    }
+
+    size_t uBlock = (c + 1) * GRANULE;
+    if (pPool->uCarveLeft < uBlock) {
+        // whatever is left of the old chunk is too small for this class, so
+        // it goes on the free list of the class it is
+        if (pPool->uCarveLeft) {
+            size_t lc        = class_of(pPool->uCarveLeft);
+            free_s *pLeft    = (free_s *)pPool->pCarve;
+            pLeft->pNext     = pPool->pFree[lc];
+            pPool->pFree[lc] = pLeft;
+        }
+
+        chunk_s *pChunk = (chunk_s *)malloc(CHUNK_SIZE);
+        if (!pChunk) return NULL;
+        pChunk->pNext  = pPool->pChunks;
+        pPool->pChunks = pChunk;
+        pPool->stats.uChunkBytes += CHUNK_SIZE;
+
+        // keep blocks aligned as malloc would
+        pPool->pCarve     = (char *)pChunk + GRANULE;
+        pPool->uCarveLeft = CHUNK_SIZE - GRANULE;
+    }
+
+    void *p = pPool->pCarve;
+    pPool->pCarve += uBlock;
+    pPool->uCarveLeft -= uBlock;
+    return p;
+}
+
+static void small_free(pool_s *pPool, void *ptr, size_t size)
+{
+    size_t c        = class_of(size);
+    free_s *pBlk    = (free_s *)ptr;
+    pBlk->pNext     = pPool->pFree[c];
+    pPool->pFree[c] = pBlk;
+}
+
+void *alloc(void *ud, void *ptr, size_t osize, size_t nsize)
+{
+    pool_s *pPool = (pool_s *)ud;
+    void *pResult = NULL;
+
+    // Lua always tells us the old size, and it's 0 when ptr is NULL
+    if (!ptr) osize = 0;
+
+    bool bOldSmall = (osize > 0) && (osize <= MAX_SMALL);
+    bool bNewSmall = (nsize > 0) && (nsize <= MAX_SMALL);
+
+    if (nsize == 0) {
+        if (bOldSmall) small_free(pPool, ptr, osize);
+        else free(ptr);
+    } else if (bOldSmall && bNewSmall && (class_of(osize) == class_of(nsize))) {
+        // still fits where it is
+        pResult = ptr;
+    } else if (!bNewSmall && (osize > MAX_SMALL)) {
+        pResult = realloc(ptr, nsize);
+        if (pResult) pPool->stats.uLargeAllocs++;
+    } else {
+        // moving between the pool and malloc, or between size classes
+        if (bNewSmall) {
+            pResult = small_alloc(pPool, nsize);
+        } else {
+            pResult = malloc(nsize);
+            if (pResult) pPool->stats.uLargeAllocs++;
+        }
+
+        if (pResult && ptr) {
+            memcpy(pResult, ptr, (osize < nsize) ? osize : nsize);
+            if (bOldSmall) small_free(pPool, ptr, osize);
+            else free(ptr);
+        }
+    }
+
+    // (a failed allocation leaves the old block alone, as Lua expects)
+    if (pResult || (nsize == 0)) {
+        pPool->stats.uInUse += nsize;
+        pPool->stats.uInUse -= osize;
+        if (pPool->stats.uInUse > pPool->stats.uPeak) pPool->stats.uPeak = pPool->stats.uInUse;
+    }
+    return pResult;
+}
+
+void get_stats(const pool_s *pPool, stats_s *pStats)
+{
+    if (pPool) *pStats = pPool->stats;
+    else memset(pStats, 0, sizeof(*pStats));
+}
+}
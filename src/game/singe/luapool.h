@@ -0,0 +1,60 @@
+/*
+ * luapool.h
+ *
+ * This file is part of HYPSEUS, a laserdisc arcade game emulator
+ *
+ * HYPSEUS is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * HYPSEUS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// The allocator Singe's Lua state is created with.
+// Nearly everything a script allocates (strings, tables, closures, upvalues)
+// is small, so blocks up to MAX_SMALL bytes come from per-size free lists
+// carved out of big chunks instead of going through malloc and free each
+// time.  Bigger blocks (table arrays, long strings) still use realloc.
+// The pool isn't thread safe: it's only used by the one Lua state.
+
+#ifndef LUAPOOL_H
+#define LUAPOOL_H
+
+#include <stddef.h>
+
+namespace luapool
+{
+// blocks are rounded up to a multiple of this
+static const size_t GRANULE = 16;
+static const size_t MAX_SMALL = 256;
+
+struct stats_s {
+    size_t uInUse;       // bytes Lua has asked for and not given back
+    size_t uPeak;        // highest uInUse has been
+    size_t uChunkBytes;  // bytes the pool has taken from malloc for small blocks
+    size_t uSmallAllocs; // small blocks handed out
+    size_t uLargeAllocs; // blocks passed on to realloc
+};
+
+struct pool_s;
+
+pool_s *create();
+
+// frees every chunk (so call it after lua_close)
+void destroy(pool_s *pPool);
+
+// a lua_Alloc: pass it to lua_newstate with the pool as 'ud'
+void *alloc(void *ud, void *ptr, size_t osize, size_t nsize);
+
+void get_stats(const pool_s *pPool, stats_s *pStats);
+}
+
+#endif // LUAPOOL_H
@@ -0,0 +1,250 @@
+/*
+ * luaprofile.cpp
+ *
+ * This file is part of HYPSEUS, a laserdisc arcade game emulator
+ *
+ * HYPSEUS is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * HYPSEUS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "luaprofile.h"
+#include <SDL.h>
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <map>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace luaprofile
+{
+// how many lines of the sample report to write
+static const size_t MAX_REPORT_LINES = 40;
+
+// onOverlayUpdate times are counted in buckets up to these many ms
+static const unsigned int FRAME_BUCKETS[] = {1, 2, 4, 8, 16, 33};
+static const int FRAME_BUCKET_COUNT = sizeof(FRAME_BUCKETS) / sizeof(FRAME_BUCKETS[0]);
+
+struct timing_s {
+    string name;
+    Uint64 uCalls;
+    Uint64 uTicks;    // in all
+    Uint64 uMaxTicks; // longest single call
+};
+
+struct api_s {
+    timing_s t;
+    lua_CFunction fn;
+};
+
+vector<api_s> g_apis;
+map<string, timing_s> g_host; // from add_time (in microseconds, not ticks)
+map<string, Uint64> g_samples; // ticks charged to each "source:line"
+
+Uint64 g_uFreq       = 1;
+Uint64 g_uStart      = 0;
+Uint64 g_uLastSample = 0;
+
+timing_s g_frames;
+Uint64 g_uFrameStart = 0;
+Uint64 g_uFrameBuckets[FRAME_BUCKET_COUNT + 1];
+
+static void add(timing_s &t, Uint64 uTicks)
+{
+    t.uCalls++;
+    t.uTicks += uTicks;
+    if (uTicks > t.uMaxTicks) t.uMaxTicks = uTicks;
+}
+
+static double to_ms(Uint64 uTicks) { return (uTicks * 1000.0) / g_uFreq; }
+
+// stands in for each wrapped function: upvalue 1 is its index in g_apis
+static int profiled_call(lua_State *L)
+{
+    size_t i     = (size_t)lua_tointeger(L, lua_upvalueindex(1));
+    Uint64 start = SDL_GetPerformanceCounter();
+
+    // the function runs in this call's frame, so it sees the same arguments
+    // (an error skips the timing, which is fine)
+    int result = g_apis[i].fn(L);
+
+    add(g_apis[i].t, SDL_GetPerformanceCounter() - start);
+    return result;
+}
+
+static void hook(lua_State *L, lua_Debug *ar)
+{
+    Uint64 now    = SDL_GetPerformanceCounter();
+    Uint64 uTicks = now - g_uLastSample;
+    g_uLastSample = now;
+
+    if (ar->event != LUA_HOOKCOUNT) return;
+
+    lua_Debug where;
+    char key[LUA_IDSIZE + 16];
+    if (lua_getstack(L, 0, &where) && lua_getinfo(L, "Sl", &where)) {
+        snprintf(key, sizeof(key), "%s:%d", where.short_src, where.currentline);
+    } else {
+        snprintf(key, sizeof(key), "?");
+    }
+    g_samples[key] += uTicks;
+}
+
+void start(lua_State *L)
+{
+    g_uFreq  = SDL_GetPerformanceFrequency();
+    g_uStart = g_uLastSample = SDL_GetPerformanceCounter();
+    g_apis.clear();
+    g_host.clear();
+    g_samples.clear();
+    g_frames = timing_s();
+    memset(g_uFrameBuckets, 0, sizeof(g_uFrameBuckets));
+
+    // Replacing fields that are already there is allowed while walking the
+    // table (rawset, so Singe's callback watch on _G isn't bothered).
+    // Functions with upvalues are left alone: the wrapper's own upvalue would
+    // be the one they see (pairs and ipairs keep their iterator in theirs).
+    lua_pushnil(L);
+    while (lua_next(L, LUA_GLOBALSINDEX)) {
+        bool bUpvalues = false;
+        if (lua_iscfunction(L, -1) && lua_getupvalue(L, -1, 1)) {
+            lua_pop(L, 1);
+            bUpvalues = true;
+        }
+
+        if (lua_type(L, -2) == LUA_TSTRING && lua_iscfunction(L, -1) && !bUpvalues) {
+            api_s api;
+            api.t.name      = lua_tostring(L, -2);
+            api.t.uCalls    = 0;
+            api.t.uTicks    = 0;
+            api.t.uMaxTicks = 0;
+            api.fn          = lua_tocfunction(L, -1);
+            g_apis.push_back(api);
+
+            lua_pushvalue(L, -2);
+            lua_pushinteger(L, (lua_Integer)(g_apis.size() - 1));
+            lua_pushcclosure(L, profiled_call, 1);
+            // and the wrapper's environment is the one the function expects
+            // (require and module keep the package tables in theirs)
+            lua_getfenv(L, -3);
+            lua_setfenv(L, -2);
+            lua_rawset(L, LUA_GLOBALSINDEX);
+        }
+        lua_pop(L, 1);
+    }
+
+    lua_sethook(L, hook, LUA_MASKCOUNT, SAMPLE_INSTRUCTIONS);
+}
+
+void stop(lua_State *L) { lua_sethook(L, NULL, 0, 0); }
+
+void frame_begin()
+{
+    g_uFrameStart = SDL_GetPerformanceCounter();
+    // the time since the last frame wasn't spent in the script
+    g_uLastSample = g_uFrameStart;
+}
+
+void frame_end()
+{
+    Uint64 uTicks = SDL_GetPerformanceCounter() - g_uFrameStart;
+    add(g_frames, uTicks);
+
+    double dMs = to_ms(uTicks);
+    int b = 0;
+    while ((b < FRAME_BUCKET_COUNT) && (dMs >= FRAME_BUCKETS[b])) b++;
+    g_uFrameBuckets[b]++;
+}
+
+void add_time(const char *name, unsigned int uUs)
+{
+    timing_s &t = g_host[name];
+    t.name = name;
+    add(t, uUs);
+}
+
+static bool by_time(const timing_s &a, const timing_s &b) { return a.uTicks > b.uTicks; }
+
+static bool by_ticks(const pair<string, Uint64> &a, const pair<string, Uint64> &b)
+{
+    return a.second > b.second;
+}
+
+static void write_timings(FILE *f, vector<timing_s> &v, double dTickMs)
+{
+    sort(v.begin(), v.end(), by_time);
+    fprintf(f, "  %-24s %10s %12s %10s %10s\n", "", "calls", "total ms", "avg us", "max us");
+    for (size_t i = 0; i < v.size(); i++) {
+        const timing_s &t = v[i];
+        if (!t.uCalls) continue;
+        fprintf(f, "  %-24s %10llu %12.2f %10.1f %10.1f\n", t.name.c_str(),
+                (unsigned long long)t.uCalls, t.uTicks * dTickMs,
+                (t.uTicks * dTickMs * 1000.0) / t.uCalls, t.uMaxTicks * dTickMs * 1000.0);
+    }
+}
+
+bool write_report(const char *path, const char *title)
+{
+    FILE *f = fopen(path, "w");
+    if (!f) return false;
+
+    double dRunMs = to_ms(SDL_GetPerformanceCounter() - g_uStart);
+    fprintf(f, "Singe profile: %s\n", title);
+    fprintf(f, "%.1f s, %llu frames\n\n", dRunMs / 1000.0, (unsigned long long)g_frames.uCalls);
+
+    fprintf(f, "onOverlayUpdate\n");
+    if (g_frames.uCalls) {
+        fprintf(f, "  avg %.3f ms, max %.3f ms, %.1f%% of the run\n",
+                to_ms(g_frames.uTicks) / g_frames.uCalls, to_ms(g_frames.uMaxTicks),
+                dRunMs > 0 ? (to_ms(g_frames.uTicks) * 100.0) / dRunMs : 0.0);
+        for (int b = 0; b <= FRAME_BUCKET_COUNT; b++) {
+            if (b < FRAME_BUCKET_COUNT)
+                fprintf(f, "  < %2u ms %10llu\n", FRAME_BUCKETS[b],
+                        (unsigned long long)g_uFrameBuckets[b]);
+            else
+                fprintf(f, "  >=%2u ms %10llu\n", FRAME_BUCKETS[b - 1],
+                        (unsigned long long)g_uFrameBuckets[b]);
+        }
+    }
+
+    vector<timing_s> v;
+    for (map<string, timing_s>::iterator i = g_host.begin(); i != g_host.end(); ++i)
+        v.push_back(i->second);
+    if (!v.empty()) {
+        fprintf(f, "\nHypseus\n");
+        write_timings(f, v, 0.001); // (these are in microseconds)
+    }
+
+    v.clear();
+    for (size_t i = 0; i < g_apis.size(); i++) v.push_back(g_apis[i].t);
+    fprintf(f, "\nFunctions called by the script (including any Lua they call)\n");
+    write_timings(f, v, 1000.0 / g_uFreq);
+
+    vector<pair<string, Uint64> > s(g_samples.begin(), g_samples.end());
+    sort(s.begin(), s.end(), by_ticks);
+    Uint64 uTotal = 0;
+    for (size_t i = 0; i < s.size(); i++) uTotal += s[i].second;
+
+    fprintf(f, "\nScript lines (sampled every %d instructions)\n", SAMPLE_INSTRUCTIONS);
+    fprintf(f, "  %-40s %12s %8s\n", "", "ms", "%");
+    for (size_t i = 0; (i < s.size()) && (i < MAX_REPORT_LINES); i++) {
+        fprintf(f, "  %-40s %12.2f %7.1f%%\n", s[i].first.c_str(), to_ms(s[i].second),
+                uTotal ? (s[i].second * 100.0) / uTotal : 0.0);
+    }
+
+    return fclose(f) == 0;
+}
+}
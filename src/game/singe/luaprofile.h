@@ -0,0 +1,60 @@
+/*
+ * luaprofile.h
+ *
+ * This file is part of HYPSEUS, a laserdisc arcade game emulator
+ *
+ * HYPSEUS is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * HYPSEUS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// The profiler behind -singe_profile.
+// - Every C function the script can call as a global (Singe's API and Lua's
+//   own) is wrapped, to count its calls and time them, apart from those with
+//   upvalues of their own (pairs, ipairs, newproxy).
+// - A count hook samples where the script is every SAMPLE_INSTRUCTIONS VM
+//   instructions, and charges the time since the last sample to that line.
+// - Each frame's onOverlayUpdate is timed.
+// - Hypseus can add its own timings (the blit, say) with add_time().
+// All of it goes into a text report at the end.
+
+#ifndef LUAPROFILE_H
+#define LUAPROFILE_H
+
+extern "C" {
+#include "lua.h"
+}
+
+namespace luaprofile
+{
+static const int SAMPLE_INSTRUCTIONS = 1000;
+
+// Wraps the global C functions and installs the hook.  Call it once the API
+// is registered, and before the script runs.
+void start(lua_State *L);
+
+// stops sampling (before the state is closed)
+void stop(lua_State *L);
+
+// around each onOverlayUpdate
+void frame_begin();
+void frame_end();
+
+// notes 'uUs' microseconds spent on 'name' outside of Lua
+void add_time(const char *name, unsigned int uUs);
+
+// writes what was gathered to 'path', false if it couldn't
+bool write_report(const char *path, const char *title);
+}
+
+#endif // LUAPROFILE_H
@@ -2,7 +2,7 @@
 #define SINGE_INTERFACE_H
 
 // increase this number every time you change something in this file!!!
-#define SINGE_INTERFACE_API_VERSION 5
+#define SINGE_INTERFACE_API_VERSION 10
 
 // info provided to Singe from Hypseus
 struct singe_in_info
@@ -62,9 +62,28 @@ struct singe_in_info
 	// VLDP Interface
 	struct vldp_in_info        *g_local_info;
 	const struct vldp_out_info *g_vldp_info;
+
+	// where compiled scripts are cached (NULL to always compile from source)
+	const char *cache_dir;
 	
 };
 
+// how Singe's Lua state is doing for memory
+struct singe_lua_stats
+{
+	unsigned int uHeapKB;       // allocated by Lua right now
+	unsigned int uPeakKB;       // the most it has had at once
+	unsigned int uPoolKB;       // taken from malloc for the small block pool
+	unsigned int uSmallAllocs;  // allocations served by the pool
+	unsigned int uLargeAllocs;  // allocations passed on to malloc
+	// only with the collector driven by sep_gc_step:
+	unsigned int uGcSteps;
+	unsigned int uGcCycles;     // collections finished
+	unsigned int uGcForced;     // full collections done because the steps fell behind
+	unsigned int uGcMaxUs;      // longest sep_gc_step
+	double dGcTotalMs;          // time spent in sep_gc_step
+};
+
 // info provided from Singe to Hypseus
 struct singe_out_info
 {
@@ -74,6 +93,7 @@ struct singe_out_info
 	// FUNCTIONS:
 	void (*sep_call_lua)(const char *func, const char *sig, ...);
 	void (*sep_do_blit)(SDL_Surface *srfDest);
+	SDL_Surface *(*sep_get_surface)(void); // the 32-bit overlay Singe draws into
 	void (*sep_do_mouse_move)(Uint16 x, Uint16 y, Sint16 xrel, Sint16 yrel);
 	void (*sep_error)(const char *fmt, ...);
 	void (*sep_print)(const char *fmt, ...);
@@ -81,6 +101,22 @@ struct singe_out_info
 	void (*sep_set_surface)(int width, int height);
 	void (*sep_shutdown)(void);
 	void (*sep_startup)(const char *script);
+
+	// the script's callbacks, without going through sep_call_lua
+	int  (*sep_on_overlay_update)(void);             // returns what onOverlayUpdate did
+	void (*sep_on_input)(int input, bool bPressed);  // onInputPressed/onInputReleased
+	void (*sep_on_shutdown)(void);
+	// Lua's garbage collector.  With sep_set_gc_manual(true) (before sep_startup)
+	// it only runs when sep_gc_step is called, for about uBudgetUs each time;
+	// sep_gc_step returns true when that finished a collection.
+	void (*sep_set_gc_manual)(bool bEnabled);
+	bool (*sep_gc_step)(unsigned int uBudgetUs);
+	void (*sep_get_lua_stats)(struct singe_lua_stats *pStats);
+	// -singe_profile: profile the script, and write a report to 'path' when
+	// Singe shuts down (call before sep_startup).  Hypseus can add its own
+	// timings to the report with sep_profile_time.
+	void (*sep_set_profile)(const char *path);
+	void (*sep_profile_time)(const char *name, unsigned int uUs);
 	
 	////////////////////////////////////////////////////////////
 };
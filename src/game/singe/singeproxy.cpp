@@ -22,10 +22,18 @@
 
 #include "singeproxy.h"
 #include "singe_interface.h"
+#include "luapool.h"
+#include "luaprofile.h"
 
 #include "../../video/video.h"
+#include "../../video/spritebatch.h"
+#include "../../video/textcache.h"
 #include "../../sound/sound.h"
 
+#include <sys/stat.h>
+#include <stdio.h>
+#include <map>
+#include <string>
 #include <vector>
 
 using namespace std;
@@ -50,6 +58,25 @@ unsigned int *g_se_uDiscFPKS;
 // used to know whether try to shutdown lua would crash
 bool g_bLuaInitialized = false;
 
+// what the Lua state allocates from (NULL if it's using plain realloc)
+luapool::pool_s *g_sep_pool = NULL;
+
+// whether Hypseus drives the garbage collector with sep_gc_step
+bool g_sep_gc_manual = false;
+struct singe_lua_stats g_sep_gc_stats;
+int g_sep_gc_live_kb = 0; // heap size after the last collection
+
+// Once the heap is this many times what was live after the last collection
+// (and at least SEP_GC_FORCE_MIN_KB), the script is making garbage faster
+// than the steps clear it, so it gets a full collection.
+#define SEP_GC_FORCE_FACTOR 4
+#define SEP_GC_FORCE_MIN_KB 4096
+
+// -singe_profile: where the report goes (empty if not profiling)
+string g_sep_profile_path;
+bool   g_sep_profiling = false;
+string g_sep_script; // (for the report's title)
+
 bool g_se_saveme = true;
 
 // Communications from the DLL to and from Hypseus
@@ -72,6 +99,25 @@ bool				  g_pause_state		    = false; // by RDG2010
 int (*g_original_prepare_frame)(uint8_t *Yplane, uint8_t *Uplane, uint8_t *Vplane,
                int Ypitch, int Upitch, int Vpitch);
 
+// The script's callbacks.  They stay ordinary globals, since scripts can
+// replace them at any time (switching input handlers, say), but their names
+// are interned once and kept in the Lua registry, so a call only costs a
+// table lookup rather than building the name string every time.
+enum {
+	SEP_CB_OVERLAY_UPDATE,
+	SEP_CB_INPUT_PRESSED,
+	SEP_CB_INPUT_RELEASED,
+	SEP_CB_MOUSE_MOVED,
+	SEP_CB_SOUND_COMPLETED,
+	SEP_CB_SHUTDOWN,
+	SEP_CB_COUNT
+};
+const char *g_sep_cb_names[SEP_CB_COUNT] = {
+	"onOverlayUpdate", "onInputPressed", "onInputReleased",
+	"onMouseMoved", "onSoundCompleted", "onShutdown"
+};
+int  g_sep_cb_name_refs[SEP_CB_COUNT]; // registry refs of the names above
+
 ////////////////////////////////////////////////////////////////////////////////
 
 extern "C"
@@ -86,6 +132,7 @@ SINGE_EXPORT const struct singe_out_info *singeproxy_init(const struct singe_in_
 
 	g_SingeOut.sep_call_lua            = sep_call_lua;
 	g_SingeOut.sep_do_blit             = sep_do_blit;
+	g_SingeOut.sep_get_surface         = sep_get_surface;
 	g_SingeOut.sep_do_mouse_move       = sep_do_mouse_move;
 	g_SingeOut.sep_error               = sep_error;
 	g_SingeOut.sep_print               = sep_print;
@@ -93,6 +140,14 @@ SINGE_EXPORT const struct singe_out_info *singeproxy_init(const struct singe_in_
 	g_SingeOut.sep_set_surface         = sep_set_surface;
 	g_SingeOut.sep_shutdown            = sep_shutdown;
 	g_SingeOut.sep_startup             = sep_startup;
+	g_SingeOut.sep_on_overlay_update   = sep_on_overlay_update;
+	g_SingeOut.sep_on_input            = sep_on_input;
+	g_SingeOut.sep_on_shutdown         = sep_on_shutdown;
+	g_SingeOut.sep_set_gc_manual       = sep_set_gc_manual;
+	g_SingeOut.sep_gc_step             = sep_gc_step;
+	g_SingeOut.sep_get_lua_stats       = sep_get_lua_stats;
+	g_SingeOut.sep_set_profile         = sep_set_profile;
+	g_SingeOut.sep_profile_time        = sep_profile_time;
 	
 	result = &g_SingeOut;
 	
@@ -196,6 +251,88 @@ void sep_call_lua(const char *func, const char *sig, ...)
 		lua_pop(g_se_lua_context, popCount);
 }
 
+// called once the script has been run
+static void sep_resolve_callbacks()
+{
+	lua_State *L = g_se_lua_context;
+
+	for (int cb = 0; cb < SEP_CB_COUNT; cb++) {
+		lua_pushstring(L, g_sep_cb_names[cb]);
+		g_sep_cb_name_refs[cb] = luaL_ref(L, LUA_REGISTRYINDEX);
+	}
+}
+
+// pushes callback 'cb', or returns false if the script doesn't have one
+static bool sep_push_callback(int cb)
+{
+	if (!g_bLuaInitialized) return false;
+
+	// same as lua_getglobal(), metatables on _G included
+	if (g_sep_cb_name_refs[cb] != LUA_NOREF) {
+		lua_rawgeti(g_se_lua_context, LUA_REGISTRYINDEX, g_sep_cb_name_refs[cb]);
+		lua_gettable(g_se_lua_context, LUA_GLOBALSINDEX);
+	} else {
+		lua_getglobal(g_se_lua_context, g_sep_cb_names[cb]);
+	}
+
+	if (!lua_isfunction(g_se_lua_context, -1)) {
+		lua_pop(g_se_lua_context, 1);
+		return false;
+	}
+	return true;
+}
+
+// calls the callback pushed by sep_push_callback, returns false if it failed
+// (in which case Lua has been shut down)
+static bool sep_run_callback(int cb, int narg, int nres)
+{
+	if (lua_pcall(g_se_lua_context, narg, nres, 0) != 0) {
+		sep_error("error running function '%s': %s", g_sep_cb_names[cb],
+		          lua_tostring(g_se_lua_context, -1));
+		return false;
+	}
+	return true;
+}
+
+int sep_on_overlay_update()
+{
+	int result = 0;
+
+	if (!sep_push_callback(SEP_CB_OVERLAY_UPDATE)) {
+		if (g_bLuaInitialized) sep_error("onOverlayUpdate is not a function");
+		return result;
+	}
+
+	if (g_sep_profiling) luaprofile::frame_begin();
+	bool ok = sep_run_callback(SEP_CB_OVERLAY_UPDATE, 0, 1);
+	if (g_sep_profiling) luaprofile::frame_end();
+	if (!ok) return result;
+
+	if (!lua_isnumber(g_se_lua_context, -1)) {
+		sep_error("wrong result type");
+		return result;
+	}
+	result = (int)lua_tonumber(g_se_lua_context, -1);
+	lua_pop(g_se_lua_context, 1);
+
+	return result;
+}
+
+void sep_on_input(int input, bool bPressed)
+{
+	int cb = bPressed ? SEP_CB_INPUT_PRESSED : SEP_CB_INPUT_RELEASED;
+
+	if (!sep_push_callback(cb)) return;
+	lua_pushnumber(g_se_lua_context, input);
+	sep_run_callback(cb, 1, 0);
+}
+
+void sep_on_shutdown()
+{
+	if (!sep_push_callback(SEP_CB_SHUTDOWN)) return;
+	sep_run_callback(SEP_CB_SHUTDOWN, 0, 0);
+}
+
 void sep_capture_vldp()
 {
 	// Intercept VLDP callback
@@ -234,6 +371,41 @@ void sep_do_blit(SDL_Surface *srfDest)
 	sep_srf32_to_srf8(g_se_surface, srfDest);
 }
 
+// Draws 'src' on the overlay at 'dest', or with -gpu_sprites queues it for the
+// renderer to draw over the overlay
+void sep_overlay_draw(SDL_Surface *src, SDL_Rect *dest)
+{
+	if (!spritebatch::is_enabled()) {
+		SDL_BlitSurface(src, NULL, g_se_surface, dest);
+		return;
+	}
+
+	if (spritebatch::size() >= spritebatch::MAX_QUEUED)
+		spritebatch::bake(g_se_surface);
+
+	SDL_BlendMode mode;
+	SDL_GetSurfaceBlendMode(src, &mode);
+
+	// A NONE blit of a sprite with alpha replaces the overlay's pixels rather
+	// than blending over them, so if it lands on an earlier sprite it has to
+	// go into the overlay for real.
+	if ((mode == SDL_BLENDMODE_NONE) && src->format->Amask) {
+		SDL_Rect r = {dest->x, dest->y, src->w, src->h};
+		if (spritebatch::overlaps(r)) {
+			spritebatch::bake(g_se_surface);
+			SDL_BlitSurface(src, NULL, g_se_surface, dest);
+			return;
+		}
+	}
+
+	spritebatch::add(src, *dest, mode);
+}
+
+SDL_Surface *sep_get_surface()
+{
+	return g_se_surface;
+}
+
 void sep_do_mouse_move(Uint16 x, Uint16 y, Sint16 xrel, Sint16 yrel)
 {
 	static bool debounced = false;
@@ -253,7 +425,12 @@ void sep_do_mouse_move(Uint16 x, Uint16 y, Sint16 xrel, Sint16 yrel)
 	xr *= g_sep_overlay_scale_x;
 	yr *= g_sep_overlay_scale_y;
 	
-	sep_call_lua("onMouseMoved", "iiii", x1, y1, xr, yr);
+	if (!sep_push_callback(SEP_CB_MOUSE_MOVED)) return;
+	lua_pushnumber(g_se_lua_context, x1);
+	lua_pushnumber(g_se_lua_context, y1);
+	lua_pushnumber(g_se_lua_context, xr);
+	lua_pushnumber(g_se_lua_context, yr);
+	sep_run_callback(SEP_CB_MOUSE_MOVED, 4, 0);
 }
 
 void sep_error(const char *fmt, ...)
@@ -264,6 +441,7 @@ void sep_error(const char *fmt, ...)
 	va_start(argp, fmt);
 	vsprintf(message, fmt, argp);
 	lua_close(g_se_lua_context);
+	g_bLuaInitialized = false; // no more callbacks, and don't close it again
 	sep_die(message);
 }
 
@@ -345,7 +523,9 @@ void sep_set_surface(int width, int height)
 	}
 	
 	if (createSurface) {
-		g_se_surface = SDL_CreateRGBSurface(0, g_se_overlay_width, g_se_overlay_height, 32, 0xFF, 0xFF00, 0xFF0000, 0xFF000000);
+		// same layout as the video blitter, so the overlay can be copied
+		// straight over (see video::vid_update_overlay_surface)
+		g_se_surface = SDL_CreateRGBSurface(0, g_se_overlay_width, g_se_overlay_height, 32, 0xFF000000, 0xFF0000, 0xFF00, 0xFF);
 		g_sep_overlay_scale_x = (double)g_se_overlay_width / (double)g_pSingeIn->get_video_width();
 		g_sep_overlay_scale_y = (double)g_se_overlay_height / (double)g_pSingeIn->get_video_height();
 	}
@@ -368,11 +548,98 @@ void sep_shutdown(void)
 
   TTF_Quit();
 
+  if (g_sep_profiling)
+  {
+	if (g_bLuaInitialized) luaprofile::stop(g_se_lua_context);
+	if (luaprofile::write_report(g_sep_profile_path.c_str(), g_sep_script.c_str()))
+		sep_print("Profile written to %s", g_sep_profile_path.c_str());
+	else
+		sep_print("Could not write the profile to %s", g_sep_profile_path.c_str());
+	g_sep_profiling = false;
+  }
+
   if (g_bLuaInitialized)
   {
 	lua_close(g_se_lua_context);
 	g_bLuaInitialized = false;
   }
+
+  // (after an error, sep_error has already closed the state)
+  luapool::destroy(g_sep_pool);
+  g_sep_pool = NULL;
+}
+
+void sep_set_gc_manual(bool bEnabled)
+{
+	g_sep_gc_manual = bEnabled;
+}
+
+void sep_set_profile(const char *path)
+{
+	g_sep_profile_path = path ? path : "";
+}
+
+void sep_profile_time(const char *name, unsigned int uUs)
+{
+	if (g_sep_profiling) luaprofile::add_time(name, uUs);
+}
+
+bool sep_gc_step(unsigned int uBudgetUs)
+{
+	bool bCycleDone = false;
+
+	if (!g_bLuaInitialized || !g_sep_gc_manual) return false;
+
+	Uint64 start  = SDL_GetPerformanceCounter();
+	Uint64 budget = (SDL_GetPerformanceFrequency() * uBudgetUs) / 1000000;
+	int heap_kb   = lua_gc(g_se_lua_context, LUA_GCCOUNT, 0);
+
+	if ((heap_kb > SEP_GC_FORCE_MIN_KB) && (heap_kb > g_sep_gc_live_kb * SEP_GC_FORCE_FACTOR))
+	{
+		lua_gc(g_se_lua_context, LUA_GCCOLLECT, 0);
+		g_sep_gc_stats.uGcForced++;
+		bCycleDone = true;
+	}
+	else
+	{
+		// at least one step, even with no time to spare, so it keeps moving
+		do {
+			g_sep_gc_stats.uGcSteps++;
+			if (lua_gc(g_se_lua_context, LUA_GCSTEP, 0)) {
+				bCycleDone = true;
+				break;
+			}
+		} while (SDL_GetPerformanceCounter() - start < budget);
+	}
+
+	// a step leaves the collector free to run on its own again
+	lua_gc(g_se_lua_context, LUA_GCSTOP, 0);
+
+	if (bCycleDone)
+	{
+		g_sep_gc_stats.uGcCycles++;
+		g_sep_gc_live_kb = lua_gc(g_se_lua_context, LUA_GCCOUNT, 0);
+	}
+
+	Uint64 us = ((SDL_GetPerformanceCounter() - start) * 1000000) / SDL_GetPerformanceFrequency();
+	if (us > g_sep_gc_stats.uGcMaxUs) g_sep_gc_stats.uGcMaxUs = (unsigned int)us;
+	g_sep_gc_stats.dGcTotalMs += us / 1000.0;
+
+	return bCycleDone;
+}
+
+void sep_get_lua_stats(struct singe_lua_stats *pStats)
+{
+	luapool::stats_s pool;
+
+	*pStats = g_sep_gc_stats;
+	luapool::get_stats(g_sep_pool, &pool);
+	pStats->uPoolKB      = (unsigned int)(pool.uChunkBytes >> 10);
+	pStats->uPeakKB      = (unsigned int)(pool.uPeak >> 10);
+	pStats->uSmallAllocs = (unsigned int)pool.uSmallAllocs;
+	pStats->uLargeAllocs = (unsigned int)pool.uLargeAllocs;
+	pStats->uHeapKB      = g_bLuaInitialized ? lua_gc(g_se_lua_context, LUA_GCCOUNT, 0)
+	                                         : (unsigned int)(pool.uInUse >> 10);
 }
 
 void sep_sound_ended(Uint8 *buffer, unsigned int slot)
@@ -390,7 +657,9 @@ void sep_sound_ended(Uint8 *buffer, unsigned int slot)
 	///////////////////////////
 	*/
 
-	sep_call_lua("onSoundCompleted", "i", slot);
+	if (!sep_push_callback(SEP_CB_SOUND_COMPLETED)) return;
+	lua_pushnumber(g_se_lua_context, slot);
+	sep_run_callback(SEP_CB_SOUND_COMPLETED, 1, 0);
 	
 }
 
@@ -475,12 +744,223 @@ bool sep_srf32_to_srf8(SDL_Surface *src, SDL_Surface *dst)
 	return bResult;
 }
 
+// Compiled scripts are cached in g_pSingeIn->cache_dir, one file per source
+// file (named after a hash of its path).  Each starts with a header saying
+// which source it was compiled from, and is only used while that source has
+// the same size and modification time.
+#define SEP_CACHE_MAGIC "HYPSEUS-SINGE-LUAC-1"
+
+struct sep_cache_header
+{
+	char     magic[sizeof(SEP_CACHE_MAGIC)];
+	Uint64   size;
+	Sint64   mtime;
+	Uint32   path_len; // the path follows the header
+};
+
+static string sep_cache_file(const char *path)
+{
+	// FNV-1a, which is plenty to tell paths apart
+	Uint64 hash = 0xcbf29ce484222325ULL;
+	char   name[32];
+
+	for (const char *c = path; *c; c++)
+	{
+		hash ^= (unsigned char)*c;
+		hash *= 0x100000001b3ULL;
+	}
+	snprintf(name, sizeof(name), "/%016llx.luac", (unsigned long long)hash);
+	return string(g_pSingeIn->cache_dir) + name;
+}
+
+static void sep_cache_make_header(sep_cache_header *hdr, const struct stat *st, const char *path)
+{
+	memset(hdr, 0, sizeof(*hdr));
+	memcpy(hdr->magic, SEP_CACHE_MAGIC, sizeof(SEP_CACHE_MAGIC));
+	hdr->size     = (Uint64)st->st_size;
+	hdr->mtime    = (Sint64)st->st_mtime;
+	hdr->path_len = (Uint32)strlen(path);
+}
+
+// loads the cached chunk for 'path' onto the stack, if there is one that's
+// still up to date
+static bool sep_cache_load(lua_State *L, const char *path, const struct stat *st)
+{
+	sep_cache_header want, hdr;
+	vector<char>     buf;
+	bool             result = false;
+	FILE            *f      = fopen(sep_cache_file(path).c_str(), "rb");
+
+	if (!f) return false;
+
+	sep_cache_make_header(&want, st, path);
+	if (fread(&hdr, sizeof(hdr), 1, f) == 1 && memcmp(&hdr, &want, sizeof(hdr)) == 0)
+	{
+		vector<char> cached_path(hdr.path_len);
+		long start;
+
+		if ((hdr.path_len == 0 || fread(&cached_path[0], hdr.path_len, 1, f) == 1) &&
+			memcmp(cached_path.empty() ? "" : &cached_path[0], path, hdr.path_len) == 0 &&
+			(start = ftell(f)) >= 0 && fseek(f, 0, SEEK_END) == 0)
+		{
+			long end = ftell(f);
+			if (end > start && fseek(f, start, SEEK_SET) == 0)
+			{
+				buf.resize(end - start);
+				if (fread(&buf[0], buf.size(), 1, f) == 1)
+				{
+					string chunkname = string("@") + path;
+					// lundump checks the chunk was made by this Lua, with these sizes
+					result = (luaL_loadbuffer(L, &buf[0], buf.size(), chunkname.c_str()) == 0);
+					if (!result) lua_pop(L, 1);
+				}
+			}
+		}
+	}
+
+	fclose(f);
+	return result;
+}
+
+static int sep_cache_writer(lua_State *L, const void *p, size_t sz, void *ud)
+{
+	vector<char> *out = (vector<char> *)ud;
+	out->insert(out->end(), (const char *)p, (const char *)p + sz);
+	return 0;
+}
+
+// saves the chunk on top of the stack as the compiled form of 'path'
+static void sep_cache_save(lua_State *L, const char *path, const struct stat *st)
+{
+	sep_cache_header hdr;
+	vector<char>     code;
+	string           file = sep_cache_file(path);
+	string           temp = file + ".tmp";
+
+	if (lua_dump(L, sep_cache_writer, &code) != 0 || code.empty()) return;
+
+	// written to the side and renamed, so another copy of Hypseus starting
+	// at the same time never sees half a file
+	FILE *f = fopen(temp.c_str(), "wb");
+	if (!f) return;
+
+	sep_cache_make_header(&hdr, st, path);
+	bool ok = fwrite(&hdr, sizeof(hdr), 1, f) == 1 &&
+			(hdr.path_len == 0 || fwrite(path, hdr.path_len, 1, f) == 1) &&
+			fwrite(&code[0], code.size(), 1, f) == 1;
+	ok = (fclose(f) == 0) && ok;
+
+	if (ok)
+	{
+		remove(file.c_str()); // (rename won't replace a file on Windows)
+		ok = (rename(temp.c_str(), file.c_str()) == 0);
+	}
+	if (!ok) remove(temp.c_str());
+}
+
+// luaL_loadfile, through the cache
+static int sep_loadfile_cached(lua_State *L, const char *path)
+{
+	struct stat st;
+	int result;
+
+	// (no path means stdin, which isn't worth caching)
+	if (!path || !g_pSingeIn->cache_dir || stat(path, &st) != 0)
+		return luaL_loadfile(L, path);
+
+	if (sep_cache_load(L, path, &st)) return 0;
+
+	result = luaL_loadfile(L, path);
+	if (result == 0) sep_cache_save(L, path, &st);
+	return result;
+}
+
+// dofile and loadfile, as in lbaselib.c, but with the cache
+static int sep_dofile(lua_State *L)
+{
+	const char *fname = luaL_optstring(L, 1, NULL);
+	int n = lua_gettop(L);
+	if (sep_loadfile_cached(L, fname) != 0) lua_error(L);
+	lua_call(L, 0, LUA_MULTRET);
+	return lua_gettop(L) - n;
+}
+
+static int sep_loadfile(lua_State *L)
+{
+	const char *fname = luaL_optstring(L, 1, NULL);
+	if (sep_loadfile_cached(L, fname) == 0) return 1;
+	lua_pushnil(L);
+	lua_insert(L, -2); // nil, then the error message
+	return 2;
+}
+
+// require's Lua file loader, as loader_Lua in loadlib.c, but with the cache.
+// The package table is upvalue 1.
+static int sep_loader_lua(lua_State *L)
+{
+	const char *name = luaL_checkstring(L, 1);
+	const char *path;
+
+	name = luaL_gsub(L, name, ".", LUA_DIRSEP);
+	lua_getfield(L, lua_upvalueindex(1), "path");
+	path = lua_tostring(L, -1);
+	if (path == NULL)
+		luaL_error(L, LUA_QL("package.path") " must be a string");
+
+	lua_pushliteral(L, ""); // error accumulator
+	for (;;) {
+		while (*path == *LUA_PATHSEP) path++;
+		if (*path == '\0') break;
+
+		const char *end = strchr(path, *LUA_PATHSEP);
+		if (end == NULL) end = path + strlen(path);
+
+		lua_pushlstring(L, path, end - path);
+		const char *filename = luaL_gsub(L, lua_tostring(L, -1), LUA_PATH_MARK, name);
+		lua_remove(L, -2); // the template
+
+		FILE *F = fopen(filename, "r");
+		if (F) {
+			fclose(F);
+			if (sep_loadfile_cached(L, filename) != 0)
+				luaL_error(L, "error loading module " LUA_QS " from file " LUA_QS ":\n\t%s",
+				           lua_tostring(L, 1), filename, lua_tostring(L, -1));
+			return 1;
+		}
+
+		lua_pushfstring(L, "\n\tno file " LUA_QS, filename);
+		lua_remove(L, -2); // the file name
+		lua_concat(L, 2);
+		path = end;
+	}
+
+	return 1; // not found, here's where we looked
+}
+
 void sep_startup(const char *script)
 {
-  g_se_lua_context = lua_open();
+  // small blocks come from a pool rather than malloc (see luapool.h)
+  g_sep_pool = luapool::create();
+  if (g_sep_pool)
+	g_se_lua_context = lua_newstate(luapool::alloc, g_sep_pool);
+  else
+	g_se_lua_context = lua_open();
+  memset(&g_sep_gc_stats, 0, sizeof(g_sep_gc_stats));
+  g_sep_gc_live_kb = 0;
   luaL_openlibs(g_se_lua_context);
 	lua_atpanic(g_se_lua_context, sep_lua_error);
 
+  // dofile, loadfile and require's modules go through the bytecode cache too
+  lua_register(g_se_lua_context, "dofile",             sep_dofile);
+  lua_register(g_se_lua_context, "loadfile",           sep_loadfile);
+
+  lua_getglobal(g_se_lua_context, "package");
+  lua_getfield(g_se_lua_context, -1, "loaders");
+  lua_pushvalue(g_se_lua_context, -2);
+  lua_pushcclosure(g_se_lua_context, sep_loader_lua, 1);
+  lua_rawseti(g_se_lua_context, -2, 2); // in place of loader_Lua
+  lua_pop(g_se_lua_context, 2);
+
   lua_register(g_se_lua_context, "colorBackground",    sep_color_set_backcolor);
   lua_register(g_se_lua_context, "colorForeground",    sep_color_set_forecolor);
 
@@ -508,6 +988,7 @@ void sep_startup(const char *script)
 
   lua_register(g_se_lua_context, "fontLoad",           sep_font_load);
   lua_register(g_se_lua_context, "fontPrint",          sep_say_font);
+  lua_register(g_se_lua_context, "fontPrintList",      sep_say_font_list);
   lua_register(g_se_lua_context, "fontQuality",        sep_font_quality);
   lua_register(g_se_lua_context, "fontSelect",         sep_font_select);
   lua_register(g_se_lua_context, "fontToSprite",       sep_font_sprite);
@@ -521,12 +1002,14 @@ void sep_startup(const char *script)
 	lua_register(g_se_lua_context, "soundPlay",        sep_sound_play);
 
 	lua_register(g_se_lua_context, "spriteDraw",       sep_sprite_draw);
+	lua_register(g_se_lua_context, "spriteDrawList",   sep_sprite_draw_list);
 	lua_register(g_se_lua_context, "spriteGetHeight",  sep_sprite_height);
 	lua_register(g_se_lua_context, "spriteGetWidth",   sep_sprite_width);
 	lua_register(g_se_lua_context, "spriteLoad",       sep_sprite_load);
 
   lua_register(g_se_lua_context, "vldpGetHeight",      sep_mpeg_get_height);
   lua_register(g_se_lua_context, "vldpGetPixel",       sep_mpeg_get_pixel);
+  lua_register(g_se_lua_context, "vldpGetPixels",      sep_mpeg_get_pixels);
   lua_register(g_se_lua_context, "vldpGetWidth",       sep_mpeg_get_width);
   lua_register(g_se_lua_context, "vldpSetVerbose",     sep_ldp_verbose);  
 
@@ -547,6 +1030,14 @@ void sep_startup(const char *script)
   
   //////////////////
 
+  // with everything registered, so all of it is counted
+  if (!g_sep_profile_path.empty())
+  {
+	g_sep_script    = script;
+	g_sep_profiling = true;
+	luaprofile::start(g_se_lua_context);
+  }
+
   if (TTF_Init() < 0)
   {
     sep_die("Unable to initialize font library.");
@@ -562,11 +1053,25 @@ void sep_startup(const char *script)
 
 	g_bLuaInitialized = true;
 
-  if (luaL_dofile(g_se_lua_context, script) != 0)
+  for (int cb = 0; cb < SEP_CB_COUNT; cb++) g_sep_cb_name_refs[cb] = LUA_NOREF;
+
+  if (sep_loadfile_cached(g_se_lua_context, script) != 0 ||
+      lua_pcall(g_se_lua_context, 0, LUA_MULTRET, 0) != 0)
   {
 	sep_error("error compiling script: %s", lua_tostring(g_se_lua_context, -1));
 	g_bLuaInitialized = false;
   }
+  else
+  {
+	sep_resolve_callbacks();
+
+	// from here on, the collector only runs when sep_gc_step says so
+	if (g_sep_gc_manual)
+	{
+		g_sep_gc_live_kb = lua_gc(g_se_lua_context, LUA_GCCOUNT, 0);
+		lua_gc(g_se_lua_context, LUA_GCSTOP, 0);
+	}
+  }
 }
 
 
@@ -576,22 +1081,113 @@ void sep_unload_fonts(void)
 
   if (g_fontList.size() > 0)
 	{
-    for (x=0; x<(int)g_fontList.size(); x++)
+    for (x=0; x<(int)g_fontList.size(); x++) {
+      textcache::forget_font(g_fontList[x]);
       TTF_CloseFont(g_fontList[x]);
+    }
 		g_fontList.clear();
 	}
 }
 
 void sep_unload_sounds(void)
 {
-  int x;
+  // (the buffers belong to g_sep_sound_cache)
+  g_soundList.clear();
+}
+
+// Sounds are converted to the mixer's own format when they're loaded (see
+// sep_sound_convert), and kept for as long as Hypseus runs, so a script that
+// is started again doesn't have to load and convert them again.
+struct sep_sound_cache_s
+{
+	Uint64  size;
+	Sint64  mtime;
+	Uint8  *buffer;
+	Uint32  length;
+};
+
+map<string, sep_sound_cache_s> g_sep_sound_cache;
+
+// Converts 'snd' (just loaded by SDL_LoadWAV) to 16-bit stereo at the
+// mixer's rate, so that it plays at the right speed and can be mixed a block
+// at a time.  Returns false if SDL can't convert it.
+static bool sep_sound_convert(g_soundT *snd)
+{
+	SDL_AudioCVT cvt;
+	int          needed;
+
+	needed = SDL_BuildAudioCVT(&cvt, snd->audioSpec.format, snd->audioSpec.channels, snd->audioSpec.freq,
+	                           sound::FORMAT, sound::CHANNELS, sound::FREQ);
+	if (needed < 0) return false;
 
-  if (g_soundList.size() > 0)
+	if (needed > 0)
 	{
-    for (x=0; x<(int)g_soundList.size(); x++)
-			SDL_FreeWAV(g_soundList[x].buffer);
-		g_soundList.clear();
+		cvt.len = snd->length;
+		cvt.buf = (Uint8 *)SDL_malloc(cvt.len * cvt.len_mult);
+		if (!cvt.buf) return false;
+
+		memcpy(cvt.buf, snd->buffer, snd->length);
+		if (SDL_ConvertAudio(&cvt) < 0)
+		{
+			SDL_free(cvt.buf);
+			return false;
+		}
+
+		SDL_FreeWAV(snd->buffer);
+		snd->buffer = cvt.buf;
+		snd->length = cvt.len_cvt;
+	}
+
+	snd->audioSpec.format   = sound::FORMAT;
+	snd->audioSpec.channels = sound::CHANNELS;
+	snd->audioSpec.freq     = sound::FREQ;
+	return true;
+}
+
+// loads 'file', or finds it in the cache; false if it couldn't be loaded
+static bool sep_sound_get(const char *file, g_soundT *snd)
+{
+	struct stat st;
+	bool        bStat = (stat(file, &st) == 0);
+
+	map<string, sep_sound_cache_s>::iterator i = g_sep_sound_cache.find(file);
+	if (bStat && i != g_sep_sound_cache.end() &&
+		i->second.size == (Uint64)st.st_size && i->second.mtime == (Sint64)st.st_mtime)
+	{
+		memset(&snd->audioSpec, 0, sizeof(snd->audioSpec));
+		snd->audioSpec.format   = sound::FORMAT;
+		snd->audioSpec.channels = sound::CHANNELS;
+		snd->audioSpec.freq     = sound::FREQ;
+		snd->buffer             = i->second.buffer;
+		snd->length             = i->second.length;
+		return true;
 	}
+
+	if (SDL_LoadWAV(file, &snd->audioSpec, &snd->buffer, &snd->length) == NULL)
+		return false;
+
+	if (!sep_sound_convert(snd))
+	{
+		// it's still playable if the mixer can take it as it is
+		if (snd->audioSpec.format != sound::FORMAT || snd->audioSpec.freq != sound::FREQ ||
+			(snd->audioSpec.channels != 1 && snd->audioSpec.channels != 2))
+		{
+			SDL_FreeWAV(snd->buffer);
+			SDL_SetError("can't convert it to 16-bit %dHz", sound::FREQ);
+			return false;
+		}
+		sep_print("Could not convert %s, playing it as it is", file);
+	}
+
+	// (an older copy of a file that has changed is left alone, as it may
+	// still be playing)
+	sep_sound_cache_s entry;
+	entry.size   = bStat ? (Uint64)st.st_size : 0;
+	entry.mtime  = bStat ? (Sint64)st.st_mtime : 0;
+	entry.buffer = snd->buffer;
+	entry.length = snd->length;
+	g_sep_sound_cache[file] = entry;
+	return true;
 }
 
 void sep_unload_sprites(void)
@@ -838,46 +1434,46 @@ static int sep_mpeg_get_height(lua_State *L)
   return 1;
 }
 
+// turns overlay coordinates into the point of the video vldpGetPixel reads
+static SDL_Point sep_pixel_point(double x, double y)
+{
+	SDL_Point pt;
+
+	pt.x = (int)(x * ((double)g_pSingeIn->g_vldp_info->w / (double)g_se_overlay_width));
+	pt.y = (int)(y * ((double)g_pSingeIn->g_vldp_info->h / (double)g_se_overlay_height));
+	return pt;
+}
+
+static void sep_pixel_rgb(const unsigned char *yuv, unsigned char *R, unsigned char *G, unsigned char *B)
+{
+	int Y = yuv[0] - 16;
+	int U = yuv[1] - 128;
+	int V = yuv[2] - 128;
+
+	*R = sep_byte_clip(( 298 * Y           + 409 * V + 128) >> 8);
+	*G = sep_byte_clip(( 298 * Y - 100 * U - 208 * V + 128) >> 8);
+	*B = sep_byte_clip(( 298 * Y + 516 * U           + 128) >> 8);
+}
+
 static int sep_mpeg_get_pixel(lua_State *L)
 {
-        Uint32 format;
         int32_t  n                   = lua_gettop(L);
         bool     result              = false;
-        SDL_Renderer *g_renderer     = video::get_renderer();
-        SDL_Texture  *g_texture      = video::get_yuv_screen();
-        SDL_QueryTexture(g_texture, &format, NULL, NULL, NULL);
-        unsigned char pixel[SDL_BYTESPERPIXEL(format)];
+        unsigned char yuv[3];
         unsigned char R;
         unsigned char G;
         unsigned char B;
-        SDL_Rect rect;
-        int Y;
-        int U;
-        int V;
+        SDL_Point pt;
 
         if (n == 2) {
                 if (lua_isnumber(L, 1)) {
                         if (lua_isnumber(L, 2)) {
 
-				rect.h = sizeof(size_t)<<1;
-				rect.w = sizeof(size_t)<<1;
-				rect.x = (int)((double)lua_tonumber(L, 1) * ((double)g_pSingeIn->g_vldp_info->w / (double)g_se_overlay_width)-sizeof(size_t));
-				rect.y = (int)((double)lua_tonumber(L, 2) * ((double)g_pSingeIn->g_vldp_info->h / (double)g_se_overlay_height)-sizeof(size_t));
-				if (g_renderer && g_texture) {
-					if (SDL_SetRenderTarget(g_renderer, g_texture) < 0) sep_die("Could not RenderTarget in get_pixel");
-					if (SDL_RenderReadPixels(g_renderer, &rect, format, pixel, SDL_BYTESPERPIXEL(format)) < 0)
-						sep_die("Could not ReadPixel in get_pixel");
-					SDL_SetRenderTarget(g_renderer, NULL);
-				} else {
-					sep_die("Could not initialize get_pixel");
+				pt = sep_pixel_point(lua_tonumber(L, 1), lua_tonumber(L, 2));
+				if (video::vid_read_yuv_pixels(&pt, 1, yuv)) {
+					sep_pixel_rgb(yuv, &R, &G, &B);
+					result = true;
 				}
-				Y = pixel[0] - 16;
-				U = (int)rand()% 6 + (-3);
-				V = (int)rand()% 6 + (-3);
-				R = sep_byte_clip(( 298 * Y           + 409 * V + 128) >> 8);
-				G = sep_byte_clip(( 298 * Y - 100 * U - 208 * V + 128) >> 8);
-				B = sep_byte_clip(( 298 * Y + 516 * U           + 128) >> 8);
-				result = true;
 			}
 		}
 	}
@@ -894,6 +1490,80 @@ static int sep_mpeg_get_pixel(lua_State *L)
 	return 3;
 }
 
+// fetches t[i] as a number, false if it isn't one
+static bool sep_list_number(lua_State *L, int t, int i, lua_Number *out)
+{
+	bool result = false;
+
+	lua_rawgeti(L, t, i);
+	if (lua_isnumber(L, -1)) {
+		*out = lua_tonumber(L, -1);
+		result = true;
+	}
+	lua_pop(L, 1);
+	return result;
+}
+
+// vldpGetPixels({{x, y}, {x, y}, ...})
+// Returns a table with an {r, g, b} for each point, in the same order.  A point
+// that isn't two numbers gets {-1, -1, -1}, as vldpGetPixel would give.
+static int sep_mpeg_get_pixels(lua_State *L)
+{
+	int n = lua_gettop(L);
+	vector<SDL_Point> points;
+	vector<unsigned char> yuv;
+	vector<int> slot; // index into points for each entry, -1 if none
+	bool result = false;
+
+	if (n != 1 || !lua_istable(L, 1)) {
+		lua_newtable(L);
+		return 1;
+	}
+
+	int count = (int)lua_objlen(L, 1);
+	for (int i = 1; i <= count; i++) {
+		lua_Number x, y;
+		int s = -1;
+
+		lua_rawgeti(L, 1, i);
+		if (lua_istable(L, -1)) {
+			int p = lua_gettop(L);
+			if (sep_list_number(L, p, 1, &x) && sep_list_number(L, p, 2, &y)) {
+				s = (int)points.size();
+				points.push_back(sep_pixel_point(x, y));
+			}
+		}
+		lua_pop(L, 1);
+		slot.push_back(s);
+	}
+
+	// all the points come from the same frame
+	if (!points.empty()) {
+		yuv.resize(points.size() * 3);
+		result = video::vid_read_yuv_pixels(&points[0], (int)points.size(), &yuv[0]);
+	}
+
+	lua_createtable(L, count, 0);
+	for (int i = 0; i < count; i++) {
+		int rgb[3] = {-1, -1, -1};
+
+		if (slot[i] >= 0 && result) {
+			unsigned char R, G, B;
+			sep_pixel_rgb(&yuv[slot[i] * 3], &R, &G, &B);
+			rgb[0] = R;
+			rgb[1] = G;
+			rgb[2] = B;
+		}
+		lua_createtable(L, 3, 0);
+		for (int c = 0; c < 3; c++) {
+			lua_pushnumber(L, rgb[c]);
+			lua_rawseti(L, -2, c + 1);
+		}
+		lua_rawseti(L, -2, i + 1);
+	}
+	return 1;
+}
+
 
 static int sep_singe_two_pseudo_call_true(lua_State *L)
 {
@@ -914,6 +1584,7 @@ static int sep_mpeg_get_width(lua_State *L)
 static int sep_overlay_clear(lua_State *L)
 {
 	SDL_FillRect(g_se_surface, NULL, 0);
+	spritebatch::clear();
 	return 0;
 }
 
@@ -941,11 +1612,50 @@ static int sep_say(lua_State *L)
     if (lua_isnumber(L, 1))
       if (lua_isnumber(L, 2))
         if (lua_isstring(L, 3))
+				{
+					// this one goes in the overlay, so it has to go on top of
+					// whatever has been queued for the renderer
+					if (spritebatch::size()) spritebatch::bake(g_se_surface);
 					g_pSingeIn->draw_string((char *)lua_tostring(L, 3), lua_tonumber(L, 1), lua_tonumber(L, 2), g_se_surface);
+				}
 
   return 0;
 }
 
+// prints 'message' in the current font, as fontPrint does
+static void sep_print_font_at(int x, int y, const char *message)
+{
+	SDL_Surface *textsurface = NULL;
+	TTF_Font *font = g_fontList[g_fontCurrent];
+
+	// the same strings get printed every frame, so they come from the cache
+	// (which also colour keys them)
+	if (g_fontQuality >= 1 && g_fontQuality <= 3)
+		textsurface = textcache::get(font, g_fontQuality, g_colorForeground, g_colorBackground, message);
+
+	if (!(textsurface)) {
+		sep_die("Font surface is null!");
+	} else {
+		SDL_Rect dest;
+		dest.x = x;
+		dest.y = y;
+		dest.w = textsurface->w;
+		dest.h = textsurface->h;
+
+		if (dest.h == 22) // JR
+			dest.x = dest.x - ((g_se_overlay_width + (dest.x * 1.5))/112)-15;
+		else if (dest.x == 5 && dest.y == 5 && dest.h == 23) // AM
+			dest.x = dest.x + 8;
+		else if (g_se_overlay_width == 360)
+			dest.x = dest.x - ((g_se_overlay_width + (dest.x * 1.5))/28);
+
+		if (!video::get_singe_blend_sprite())
+			SDL_SetSurfaceBlendMode(textsurface, SDL_BLENDMODE_NONE);
+
+		sep_overlay_draw(textsurface, &dest);
+	}
+}
+
 static int sep_say_font(lua_State *L)
 {
   int n = lua_gettop(L);
@@ -954,49 +1664,39 @@ static int sep_say_font(lua_State *L)
     if (lua_isnumber(L, 1))
       if (lua_isnumber(L, 2))
         if (lua_isstring(L, 3))
-					if (g_fontCurrent >= 0) {
-						SDL_Surface *textsurface = NULL;
-						const char *message = lua_tostring(L, 3);
-						TTF_Font *font = g_fontList[g_fontCurrent];
-						
-						switch (g_fontQuality) {
-							case 1:
-								textsurface = TTF_RenderText_Solid(font, message, g_colorForeground);
-								break;
-							
-							case 2:
-								textsurface = TTF_RenderText_Shaded(font, message, g_colorForeground, g_colorBackground);
-								break;
-							
-							case 3:
-								textsurface = TTF_RenderText_Blended(font, message, g_colorForeground);
-								break;
-						}
-						
-						if (!(textsurface)) {
-							sep_die("Font surface is null!");
-						} else {
-							SDL_Rect dest;
-							dest.x = lua_tonumber(L, 1);
-							dest.y = lua_tonumber(L, 2);
-							dest.w = textsurface->w;
-							dest.h = textsurface->h;
-
-							if (dest.h == 22) // JR
-								dest.x = dest.x - ((g_se_overlay_width + (dest.x * 1.5))/112)-15;
-							else if (dest.x == 5 && dest.y == 5 && dest.h == 23) // AM
-								dest.x = dest.x + 8;
-							else if (g_se_overlay_width == 360)
-								dest.x = dest.x - ((g_se_overlay_width + (dest.x * 1.5))/28);
-
-							SDL_SetColorKey(textsurface, SDL_TRUE|SDL_RLEACCEL, 0);
-							if (!video::get_singe_blend_sprite())
-								SDL_SetSurfaceBlendMode(textsurface, SDL_BLENDMODE_NONE);
-
-							SDL_BlitSurface(textsurface, NULL, g_se_surface, &dest);
-							SDL_FreeSurface(textsurface);
-						}
-          }
+					if (g_fontCurrent >= 0)
+						sep_print_font_at(lua_tonumber(L, 1), lua_tonumber(L, 2), lua_tostring(L, 3));
+
+  return 0;
+}
+
+// fontPrintList({{x, y, "text"}, {x, y, "text"}, ...})
+// Entries that aren't two numbers and a string are skipped.
+static int sep_say_font_list(lua_State *L)
+{
+  int n = lua_gettop(L);
+
+  if (n == 1 && lua_istable(L, 1) && g_fontCurrent >= 0)
+  {
+    int count = (int)lua_objlen(L, 1);
+    for (int i = 1; i <= count; i++)
+    {
+      lua_rawgeti(L, 1, i);
+      if (lua_istable(L, -1))
+      {
+        int e = lua_gettop(L);
+        lua_Number x, y;
+        if (sep_list_number(L, e, 1, &x) && sep_list_number(L, e, 2, &y))
+        {
+          lua_rawgeti(L, e, 3);
+          if (lua_isstring(L, -1))
+            sep_print_font_at(x, y, lua_tostring(L, -1));
+          lua_pop(L, 1);
+        }
+      }
+      lua_pop(L, 1);
+    }
+  }
 
   return 0;
 }
@@ -1142,7 +1842,7 @@ static int sep_sound_load(lua_State *L)
 		{
 			const char *file = lua_tostring(L, 1);
 			g_soundT temp;
-			if (SDL_LoadWAV(file, &temp.audioSpec, &temp.buffer, &temp.length) == NULL)
+			if (!sep_sound_get(file, &temp))
 			{
 				sep_die("Could not open %s: %s", file, SDL_GetError());
 			} else {
@@ -1172,69 +1872,100 @@ static int sep_sound_play(lua_State *L)
   return 1;
 }
 
+// draws sprite number 'sprite', as spriteDraw does
+static void sep_draw_sprite_at(int x, int y, int sprite)
+{
+	static bool o = false;
+
+	if ((sprite < 0) || (sprite >= (int)g_spriteList.size()))
+		return;
+
+	SDL_Rect dest;
+	dest.x = x;
+	dest.y = y;
+	dest.w = g_spriteList[sprite]->w;
+	dest.h = g_spriteList[sprite]->h;
+
+	if (g_se_overlay_width == 360)
+	{
+		// Mouse sprites
+		if ((dest.w == 13 && dest.h == 13) || (dest.w == 23 && dest.h == 25) ||
+				(dest.w == 27 && dest.h == 14))
+		{
+			if (dest.w == 23) // MD
+				dest.x = dest.x - ((g_se_overlay_width + (dest.x * 1.75))/30);
+			else
+				dest.x = dest.x - ((g_se_overlay_width + (dest.x * 1.5))/32);
+		} else {
+
+			if (dest.w == 6 && dest.h == 11) // MD / MD2
+				dest.x = dest.x - ((g_se_overlay_width + (dest.x * 1.5))/112);
+			else if (dest.w == 204 && dest.h == 21) // JR
+				dest.x = dest.x - ((g_se_overlay_width + (dest.x * 1.5))/22);
+			else if (dest.x < 250 && dest.y >= 195) // CP / DW / LBH
+				dest.x = dest.x - ((g_se_overlay_width + (dest.x * 1.5))/56);
+			else if (dest.x == 300 && dest.y == 215) // TT
+				dest.x = dest.x - ((g_se_overlay_width + (dest.x * 1.5))/112);
+			else
+				dest.x = dest.x - ((g_se_overlay_width + (dest.x * 1.5))/28);
+		}
+	}
+
+	if (!o) {
+		sep_print("Overlay drawn to %d x %d", g_se_overlay_width, g_se_overlay_height);
+		o = true;
+	}
+
+	if (dest.w == 137 && dest.h == 28) // SP
+		SDL_SetColorKey(g_spriteList[sprite], SDL_FALSE|SDL_RLEACCEL, 0x000000ff);
+
+	if ((!video::get_singe_blend_sprite()) &&
+			(dest.w != 204 && dest.h != 21) && (dest.w != 11 && dest.h != 11)) // JR / AM
+		SDL_SetSurfaceBlendMode(g_spriteList[sprite], SDL_BLENDMODE_NONE);
+
+	sep_overlay_draw(g_spriteList[sprite], &dest);
+}
+
 static int sep_sprite_draw(lua_State *L)
 {
   int n = lua_gettop(L);
-  static bool o = false;
 
   if (n == 3)
     if (lua_isnumber(L, 1))
 			if (lua_isnumber(L, 2))
 				if (lua_isnumber(L, 3))
-				{
-					int sprite = lua_tonumber(L, 3);
-					if (sprite < (int)g_spriteList.size())
-					{
-						SDL_Rect dest;
-						dest.x = lua_tonumber(L, 1);
-						dest.y = lua_tonumber(L, 2);
-						dest.w = g_spriteList[sprite]->w;
-						dest.h = g_spriteList[sprite]->h;
-
-						if (g_se_overlay_width == 360)
-						{
-							// Mouse sprites
-							if ((dest.w == 13 && dest.h == 13) || (dest.w == 23 && dest.h == 25) ||
-									(dest.w == 27 && dest.h == 14))
-							{
-								if (dest.w == 23) // MD
-									dest.x = dest.x - ((g_se_overlay_width + (dest.x * 1.75))/30);
-								else
-									dest.x = dest.x - ((g_se_overlay_width + (dest.x * 1.5))/32);
-							} else {
-
-								if (dest.w == 6 && dest.h == 11) // MD / MD2
-									dest.x = dest.x - ((g_se_overlay_width + (dest.x * 1.5))/112);
-								else if (dest.w == 204 && dest.h == 21) // JR
-									dest.x = dest.x - ((g_se_overlay_width + (dest.x * 1.5))/22);
-								else if (dest.x < 250 && dest.y >= 195) // CP / DW / LBH
-									dest.x = dest.x - ((g_se_overlay_width + (dest.x * 1.5))/56);
-								else if (dest.x == 300 && dest.y == 215) // TT
-									dest.x = dest.x - ((g_se_overlay_width + (dest.x * 1.5))/112);
-								else
-									dest.x = dest.x - ((g_se_overlay_width + (dest.x * 1.5))/28);
-							}
-						}
-
-						if (!o) {
-							sep_print("Overlay drawn to %d x %d", g_se_overlay_width, g_se_overlay_height);
-							o = true;
-						}
-
-						if (dest.w == 137 && dest.h == 28) // SP
-							SDL_SetColorKey(g_spriteList[sprite], SDL_FALSE|SDL_RLEACCEL, 0x000000ff);
-
-						if ((!video::get_singe_blend_sprite()) &&
-								(dest.w != 204 && dest.h != 21) && (dest.w != 11 && dest.h != 11)) // JR / AM
-							SDL_SetSurfaceBlendMode(g_spriteList[sprite], SDL_BLENDMODE_NONE);
-
-						SDL_BlitSurface(g_spriteList[sprite], NULL, g_se_surface, &dest);
-					}
-				}
+					sep_draw_sprite_at(lua_tonumber(L, 1), lua_tonumber(L, 2), lua_tonumber(L, 3));
 	
 	return 0;
 }
 
+// spriteDrawList({{x, y, sprite}, {x, y, sprite}, ...})
+// Entries that aren't three numbers are skipped.
+static int sep_sprite_draw_list(lua_State *L)
+{
+  int n = lua_gettop(L);
+
+  if (n == 1 && lua_istable(L, 1))
+  {
+    int count = (int)lua_objlen(L, 1);
+    for (int i = 1; i <= count; i++)
+    {
+      lua_rawgeti(L, 1, i);
+      if (lua_istable(L, -1))
+      {
+        int e = lua_gettop(L);
+        lua_Number x, y, sprite;
+        if (sep_list_number(L, e, 1, &x) && sep_list_number(L, e, 2, &y) &&
+            sep_list_number(L, e, 3, &sprite))
+          sep_draw_sprite_at(x, y, sprite);
+      }
+      lua_pop(L, 1);
+    }
+  }
+
+  return 0;
+}
+
 static int sep_sprite_height(lua_State *L)
 {
   int n = lua_gettop(L);
@@ -53,11 +53,21 @@ void          sep_die(const char *fmt, ...);
 void          sep_do_blit(SDL_Surface *srfDest);
 void          sep_do_mouse_move(Uint16 x, Uint16 y, Sint16 xrel, Sint16 yrel);
 void          sep_error(const char *fmt, ...);
+bool          sep_gc_step(unsigned int uBudgetUs);
+void          sep_get_lua_stats(struct singe_lua_stats *pStats);
+SDL_Surface  *sep_get_surface();
 int           sep_lua_error(lua_State *L);
 int           sep_prepare_frame_callback(uint8_t *Yplane, uint8_t *Uplane, uint8_t *Vplane,
                            int Ypitch, int Upitch, int Vpitch);
+void          sep_on_input(int input, bool bPressed);
+int           sep_on_overlay_update();
+void          sep_on_shutdown();
+void          sep_overlay_draw(SDL_Surface *src, SDL_Rect *dest);
 void          sep_print(const char *fmt, ...);
+void          sep_profile_time(const char *name, unsigned int uUs);
 void          sep_release_vldp();
+void          sep_set_gc_manual(bool bEnabled);
+void          sep_set_profile(const char *path);
 void          sep_set_static_pointers(double *m_disc_fps, unsigned int *m_uDiscFPKS);
 void          sep_set_surface(int width, int height);
 void          sep_shutdown(void);
@@ -88,12 +98,14 @@ static int sep_get_overlay_height(lua_State *L);
 static int sep_get_overlay_width(lua_State *L);
 static int sep_mpeg_get_height(lua_State *L);
 static int sep_mpeg_get_pixel(lua_State *L);
+static int sep_mpeg_get_pixels(lua_State *L);
 static int sep_mpeg_get_width(lua_State *L);
 static int sep_overlay_clear(lua_State *L);
 static int sep_pause(lua_State *L);
 static int sep_play(lua_State *L);
 static int sep_say(lua_State *L);
 static int sep_say_font(lua_State *L);
+static int sep_say_font_list(lua_State *L);
 static int sep_screenshot(lua_State *L);
 static int sep_search(lua_State *L);
 static int sep_search_blanking(lua_State *L);
@@ -103,6 +115,7 @@ static int sep_skip_blanking(lua_State *L);
 static int sep_sound_load(lua_State *L);
 static int sep_sound_play(lua_State *L);
 static int sep_sprite_draw(lua_State *L);
+static int sep_sprite_draw_list(lua_State *L);
 static int sep_sprite_height(lua_State *L);
 static int sep_sprite_load(lua_State *L);
 static int sep_sprite_width(lua_State *L);
@@ -200,6 +200,7 @@ void thayers::shutdown()
     if (m_pScoreboard) {
         m_pScoreboard->PreDeleteInstance();
     }
+    ssi263::shutdown();
     cpu::shutdown();
 }
 
@@ -35,6 +35,7 @@
 #include "homedir.h"
 #include "input.h" // to disable joystick use
 #include "../io/numstr.h"
+#include "../video/capture.h"
 #include "../video/video.h"
 #include "../video/led.h"
 #include "../hypseus.h"
@@ -667,6 +668,22 @@ bool parse_cmd_line(int argc, char **argv)
                 sound::set_buf_size(sbsize);
                 sprintf(s, "Setting sound buffer size to %d", sbsize);
                 printline(s);
+            } else if (strcasecmp(s, "-sound_adaptive") == 0) {
+                sound::set_adaptive(true);
+                printline("Enabling adaptive sound buffer...");
+            }
+            // render the audio to a .wav file instead of playing it
+            // (the _stems variant also writes each sound chip separately)
+            else if ((strcasecmp(s, "-audio_render") == 0) ||
+                     (strcasecmp(s, "-audio_render_stems") == 0)) {
+                bool bStems = (strcasecmp(s, "-audio_render_stems") == 0);
+                get_next_word(s, sizeof(s));
+                if (s[0] == 0) {
+                    printline("-audio_render requires a .wav filename");
+                    result = false;
+                } else {
+                    sound::set_render_file(s, bStems);
+                }
             } else if (strcasecmp(s, "-volume_vldp") == 0) {
                 get_next_word(s, sizeof(s));
                 unsigned int uVolume = atoi(s);
@@ -767,6 +784,40 @@ bool parse_cmd_line(int argc, char **argv)
             else if (strcasecmp(s, "-fullscreen_window") == 0) {
                 video::set_fakefullscreen(true);
             }
+            // write every frame to the screenshots directory (png or raw)
+            else if (strcasecmp(s, "-capture") == 0) {
+                get_next_word(s, sizeof(s));
+                if (strcasecmp(s, "png") == 0) {
+                    capture::set_continuous(capture::CAPTURE_PNG);
+                } else if (strcasecmp(s, "raw") == 0) {
+                    capture::set_continuous(capture::CAPTURE_RAW);
+                } else {
+                    printline("-capture needs to be followed by png or raw");
+                    result = false;
+                }
+            }
+            // compose and present frames on their own thread
+            else if (strcasecmp(s, "-render_thread") == 0) {
+                video::set_render_thread(true);
+            }
+            // render offscreen, no display needed
+            else if (strcasecmp(s, "-headless") == 0) {
+                video::set_headless(true);
+            }
+            // write a hash of every frame to a file
+            else if (strcasecmp(s, "-frame_hash") == 0) {
+                get_next_word(s, sizeof(s));
+                if (s[0] == 0) {
+                    printline("-frame_hash needs a file name");
+                    result = false;
+                } else {
+                    video::set_frame_hash_file(s);
+                }
+            }
+            // blend the overlay into the YUV video instead of on the renderer
+            else if (strcasecmp(s, "-yuv_compose") == 0) {
+                video::set_yuv_compose(true);
+            }
             // Disable SDL_HINT_RENDER_SCALE_QUALITY(linear) for fullscreen
             else if (strcasecmp(s, "-nolinear_scale") == 0) {
                 video::set_fullscreen_scale_nearest(true);
@@ -59,6 +59,7 @@ void homedir::set_homedir(const string &s)
     make_dir(m_homedir + "/fonts");
     make_dir(m_homedir + "/framefile");
     make_dir(m_homedir + "/screenshots");
+    make_dir(m_homedir + "/cache");
 }
 
 string homedir::get_romfile(const string &s)
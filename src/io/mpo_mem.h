@@ -45,6 +45,17 @@
              ((*((Uint8 *)(ptr) + 2)) << 16) | ((*((Uint8 *)(ptr) + 3)) << 24))
 #endif
 
+// STORE_LIL_UINT16: stores 16-bit unsigned 'val' to 'ptr' in little-endian
+// format
+//  Usage: STORE_LIL_UINT16(void *ptr, Uint16 val);
+#if SDL_BYTEORDER == SDL_LIL_ENDIAN
+#define STORE_LIL_UINT16(ptr, val) *((Uint16 *)(ptr)) = (val)
+#else
+#define STORE_LIL_UINT16(ptr, val)                                             \
+    *((Uint8 *)(ptr)) = (val)&0xFF;                                            \
+    *(((Uint8 *)(ptr)) + 1) = ((val) >> 8) & 0xFF
+#endif
+
 // STORE_LIL_UINT32: stores 32-bit unsigned 'val' to 'ptr' in little-endian
 // format
 //  Usage: STORE_LIL_UINT32(void *ptr, Uint32 val);
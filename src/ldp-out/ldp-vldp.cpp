@@ -356,7 +356,7 @@ bool ldp_vldp::wait_for_status(unsigned int uStatus, const string &strFilename)
         // if we got a parse update, then show it ...
         if (g_bGotParseUpdate) {
             // redraw screen blitter before we display it
-            update_parse_meter(strFilename);
+            video::vid_run(update_parse_meter_job, (void *)&strFilename);
             video::vid_blank();
             // vid_blit(get_screen_blitter(), 0, 0);
             // video::vid_flip();
@@ -1545,6 +1545,11 @@ void update_parse_meter(const string &strFilename)
     }
 }
 
+void update_parse_meter_job(void *pstrFilename)
+{
+    update_parse_meter(*(const string *)pstrFilename);
+}
+
 // percent_complete is between 0 and 1
 // a negative value means that we are starting to parse a new file NOW
 void report_parse_progress_callback(double percent_complete_01)
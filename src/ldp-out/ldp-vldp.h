@@ -197,6 +197,7 @@ int prepare_frame_callback(uint8_t *Yplane, uint8_t *Uplane, uint8_t *Vplane,
 void display_frame_callback();
 void set_blend_fields(bool val);
 void update_parse_meter(const string &strFilename);
+void update_parse_meter_job(void *pstrFilename); // for video::vid_run
 void report_parse_progress_callback(double percent_complete);
 void report_mpeg_dimensions_callback(int, int);
 void free_yuv_overlay();
@@ -40,6 +40,7 @@
 #include "../game/game.h"
 #include "../io/conout.h"
 #include "../io/my_stdio.h"
+#include "../sound/sound.h"
 #include "../timer/timer.h"
 #include "framemod.h"
 #include "ldp.h"
@@ -653,6 +654,10 @@ void ldp::think_delay(unsigned int uMsDelay)
     for (unsigned int uMs = 0; uMs < uMsDelay; ++uMs) {
         pre_think();
 
+        // no emulated cpu to do this for us (keeps -audio_render and adaptive
+        // audio buffering going)
+        sound::update_buffer();
+
         unsigned int uElapsedMs = elapsed_ms_time(m_start_time);
 
         // if we're ahead of where we need to be, then it's ok to stall ...
@@ -32,6 +32,13 @@
 #include <assert.h>
 #endif
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) && (SDL_BYTEORDER == SDL_LIL_ENDIAN)
+#include <arm_neon.h>
+#define MIX_USE_NEON
+#endif
+
 // if we aren't using the MMX version
 
 #ifndef USE_MMX
@@ -74,6 +81,32 @@ void mix_c()
     }
 }
 
+void mix_add_s16(Uint8 *pDst, const Uint8 *pSrc, unsigned int uSamples)
+{
+    unsigned int u = 0;
+
+#if defined(__SSE2__)
+    for (; u + 8 <= uSamples; u += 8) {
+        __m128i d = _mm_loadu_si128((const __m128i *)(pDst + (u << 1)));
+        __m128i s = _mm_loadu_si128((const __m128i *)(pSrc + (u << 1)));
+        _mm_storeu_si128((__m128i *)(pDst + (u << 1)), _mm_adds_epi16(d, s));
+    }
+#elif defined(MIX_USE_NEON)
+    for (; u + 8 <= uSamples; u += 8) {
+        int16x8_t d = vld1q_s16((const int16_t *)(pDst + (u << 1)));
+        int16x8_t s = vld1q_s16((const int16_t *)(pSrc + (u << 1)));
+        vst1q_s16((int16_t *)(pDst + (u << 1)), vqaddq_s16(d, s));
+    }
+#endif
+
+    // whatever is left over (or everything, if there is no SIMD available)
+    for (; u < uSamples; ++u) {
+        int iMixed = LOAD_LIL_SINT16(pDst + (u << 1)) + LOAD_LIL_SINT16(pSrc + (u << 1));
+        DO_CLIP(iMixed);
+        STORE_LIL_UINT16(pDst + (u << 1), (Uint16)iMixed);
+    }
+}
+
 #ifdef USE_MMX
 
 #ifdef DEBUG
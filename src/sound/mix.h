@@ -52,6 +52,11 @@ struct mix_s {
 // (releasetest.cpp)
 void mix_c();
 
+// Adds 'uSamples' 16-bit little-endian samples from 'pSrc' onto 'pDst',
+// saturating instead of wrapping around.  Used by the sample mixer to mix
+// whole blocks at a time (SSE2/NEON when available).
+void mix_add_s16(Uint8 *pDst, const Uint8 *pSrc, unsigned int uSamples);
+
 // Here we make some definitions so that the MMX/C code use identical syntax and
 // variables
 #ifdef USE_MMX
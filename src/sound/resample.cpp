@@ -0,0 +1,275 @@
+/*
+ * ____ DAPHNE COPYRIGHT NOTICE ____
+ *
+ * This file is part of DAPHNE, a laserdisc arcade game emulator
+ *
+ * DAPHNE is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * DAPHNE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// resample.cpp
+//
+// Windowed-sinc polyphase resampler.  The conversion ratio is reduced to
+// uPhases/uStep (e.g. 44100 -> 48000 is 160/147) and one set of filter taps is
+// computed for each of the uPhases output phases, so every output sample is a
+// single dot product with no interpolation between tables.
+// Source audio is kept de-interleaved so that the left and right dot products
+// can each be done with SSE2 or NEON multiply-adds.
+
+#include "config.h"
+
+#include "../io/conout.h"
+#include "../io/mpo_mem.h"
+#include "resample.h"
+#include "sound.h"
+#include <math.h>
+#include <string.h>
+#include <vector>
+#include <plog/Log.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define RESAMPLE_USE_NEON
+#endif
+
+using namespace std;
+
+namespace resample
+{
+
+// filter length of each phase, must be a multiple of 8 for the SIMD code
+static const unsigned int TAPS = 32;
+
+// the most phases we are willing to build tables for
+static const unsigned int MAX_PHASES = 1024;
+
+// coefficients are stored as 1.14 fixed point so that a full scale sample
+// times a full scale coefficient fits comfortably in 32 bits
+static const int COEF_SHIFT = 14;
+
+#ifndef PI
+#define PI 3.14159265358979323846
+#endif
+
+// [phase][tap]
+static vector<Sint16> g_vCoefs;
+
+// de-interleaved source audio still waiting to be used
+static vector<Sint16> g_vLeft;
+static vector<Sint16> g_vRight;
+
+// number of source samples in g_vLeft/g_vRight
+static unsigned int g_uAvail = 0;
+
+// index of the first tap of the next output sample
+static unsigned int g_uPos = 0;
+
+// conversion ratio is g_uPhases / g_uStep
+static unsigned int g_uPhases = 0;
+static unsigned int g_uStep   = 0;
+
+// phase of the next output sample (0 to g_uPhases-1)
+static unsigned int g_uPhase = 0;
+
+static unsigned int g_uSrcRate = 0;
+
+static unsigned int gcd(unsigned int a, unsigned int b)
+{
+    while (b) {
+        unsigned int t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+bool init(unsigned int uSrcRate, unsigned int uDstRate)
+{
+    shutdown();
+
+    if ((uSrcRate == 0) || (uDstRate == 0)) {
+        return false;
+    }
+
+    unsigned int uGCD = gcd(uSrcRate, uDstRate);
+    unsigned int uPhases = uDstRate / uGCD;
+    unsigned int uStep   = uSrcRate / uGCD;
+
+    if (uPhases > MAX_PHASES) {
+        LOGW << fmt("Can't resample %u Hz to %u Hz exactly", uSrcRate, uDstRate);
+        return false;
+    }
+
+    // when going down in rate, the cutoff has to come down with it to avoid
+    // aliasing. The 0.95 leaves room for the transition band.
+    double dCutoff = 0.95;
+    if (uDstRate < uSrcRate) {
+        dCutoff *= (double)uDstRate / uSrcRate;
+    }
+
+    g_vCoefs.resize(uPhases * TAPS);
+
+    for (unsigned int uPhase = 0; uPhase < uPhases; ++uPhase) {
+        double dTaps[TAPS];
+        double dSum = 0.0;
+
+        // output sample sits between taps TAPS/2-1 and TAPS/2
+        double dFrac = (double)uPhase / uPhases;
+
+        for (unsigned int t = 0; t < TAPS; ++t) {
+            double x = (double)t - (TAPS / 2 - 1) - dFrac;
+            double dSinc = (x == 0.0) ? 1.0 : sin(PI * dCutoff * x) / (PI * dCutoff * x);
+
+            // Blackman window over the span of the filter
+            double w = (x + TAPS / 2) / TAPS;
+            double dWindow = 0.42 - 0.5 * cos(2 * PI * w) + 0.08 * cos(4 * PI * w);
+            if ((w < 0.0) || (w > 1.0)) {
+                dWindow = 0.0;
+            }
+
+            dTaps[t] = dSinc * dWindow;
+            dSum += dTaps[t];
+        }
+
+        // normalize each phase to unity gain so there is no ripple in volume
+        for (unsigned int t = 0; t < TAPS; ++t) {
+            g_vCoefs[uPhase * TAPS + t] =
+                (Sint16)floor((dTaps[t] / dSum) * (1 << COEF_SHIFT) + 0.5);
+        }
+    }
+
+    // start with half a filter's worth of silence so the first samples have
+    // something to look back at
+    g_vLeft.assign(TAPS, 0);
+    g_vRight.assign(TAPS, 0);
+    g_uAvail   = TAPS / 2 - 1;
+    g_uPos     = 0;
+    g_uPhase   = 0;
+    g_uPhases  = uPhases;
+    g_uStep    = uStep;
+    g_uSrcRate = uSrcRate;
+
+    LOGI << fmt("Resampling audio from %u Hz to %u Hz (%u phases)", uSrcRate,
+                uDstRate, uPhases);
+
+    return true;
+}
+
+void shutdown()
+{
+    g_vCoefs.clear();
+    g_vLeft.clear();
+    g_vRight.clear();
+    g_uAvail  = 0;
+    g_uPos    = 0;
+    g_uPhases = 0;
+}
+
+void push(const Uint8 *pu8Src, unsigned int uSamples)
+{
+    // throw away source samples that no output sample can reach anymore
+    if (g_uPos > 0) {
+        unsigned int uKeep = g_uAvail - g_uPos;
+        memmove(&g_vLeft[0], &g_vLeft[g_uPos], uKeep * sizeof(Sint16));
+        memmove(&g_vRight[0], &g_vRight[g_uPos], uKeep * sizeof(Sint16));
+        g_uAvail = uKeep;
+        g_uPos   = 0;
+    }
+
+    if (g_vLeft.size() < g_uAvail + uSamples) {
+        g_vLeft.resize(g_uAvail + uSamples);
+        g_vRight.resize(g_uAvail + uSamples);
+    }
+
+    Sint16 *pLeft  = &g_vLeft[g_uAvail];
+    Sint16 *pRight = &g_vRight[g_uAvail];
+
+    for (unsigned int u = 0; u < uSamples; ++u) {
+        pLeft[u]  = LOAD_LIL_SINT16(pu8Src);
+        pRight[u] = LOAD_LIL_SINT16(pu8Src + 2);
+        pu8Src += 4;
+    }
+
+    g_uAvail += uSamples;
+}
+
+// dot product of TAPS source samples and TAPS coefficients
+static inline int dot(const Sint16 *pSrc, const Sint16 *pCoef)
+{
+#if defined(__SSE2__)
+    __m128i acc = _mm_setzero_si128();
+    for (unsigned int t = 0; t < TAPS; t += 8) {
+        __m128i s = _mm_loadu_si128((const __m128i *)(pSrc + t));
+        __m128i c = _mm_loadu_si128((const __m128i *)(pCoef + t));
+        acc = _mm_add_epi32(acc, _mm_madd_epi16(s, c));
+    }
+    acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, _MM_SHUFFLE(1, 0, 3, 2)));
+    acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(acc);
+#elif defined(RESAMPLE_USE_NEON)
+    int32x4_t acc = vdupq_n_s32(0);
+    for (unsigned int t = 0; t < TAPS; t += 4) {
+        acc = vmlal_s16(acc, vld1_s16(pSrc + t), vld1_s16(pCoef + t));
+    }
+    int32x2_t sum = vadd_s32(vget_low_s32(acc), vget_high_s32(acc));
+    return vget_lane_s32(vpadd_s32(sum, sum), 0);
+#else
+    int iSum = 0;
+    for (unsigned int t = 0; t < TAPS; ++t) {
+        iSum += pSrc[t] * pCoef[t];
+    }
+    return iSum;
+#endif
+}
+
+unsigned int pull(Uint8 *pu8Dst, unsigned int uSamples)
+{
+    unsigned int uDone = 0;
+
+    // each output sample needs TAPS source samples starting at g_uPos
+    while ((uDone < uSamples) && (g_uPos + TAPS <= g_uAvail)) {
+        const Sint16 *pCoef = &g_vCoefs[g_uPhase * TAPS];
+
+        // round, then drop the coefficient scale
+        int iLeft  = (dot(&g_vLeft[g_uPos], pCoef) + (1 << (COEF_SHIFT - 1))) >> COEF_SHIFT;
+        int iRight = (dot(&g_vRight[g_uPos], pCoef) + (1 << (COEF_SHIFT - 1))) >> COEF_SHIFT;
+
+        DO_CLIP(iLeft);
+        DO_CLIP(iRight);
+
+        Uint32 val_to_store = (((Uint16)iRight) << 16) | (Uint16)iLeft;
+        STORE_LIL_UINT32(pu8Dst, val_to_store);
+        pu8Dst += 4;
+        ++uDone;
+
+        // step through the source at the conversion ratio
+        g_uPhase += g_uStep;
+        g_uPos += g_uPhase / g_uPhases;
+        g_uPhase %= g_uPhases;
+    }
+
+    return uDone;
+}
+
+double get_delay_ms()
+{
+    if (g_uSrcRate == 0) {
+        return 0.0;
+    }
+
+    return (TAPS / 2) * 1000.0 / g_uSrcRate;
+}
+}
@@ -0,0 +1,54 @@
+/*
+ * ____ DAPHNE COPYRIGHT NOTICE ____
+ *
+ * This file is part of DAPHNE, a laserdisc arcade game emulator
+ *
+ * DAPHNE is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * DAPHNE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// resample.h
+// Polyphase sample rate converter used to feed the audio device at its own
+// native rate, instead of leaving the conversion to SDL.
+
+#ifndef RESAMPLE_H
+#define RESAMPLE_H
+
+#include <SDL.h> // for data-type defs
+
+namespace resample
+{
+// Builds the filter bank to convert 16-bit stereo audio from 'uSrcRate' to
+// 'uDstRate'.
+// Returns false if the ratio between the two rates is too awkward to handle
+// exactly, in which case the caller should ask SDL for 'uSrcRate' instead
+// (see open_device in sound.cpp).
+bool init(unsigned int uSrcRate, unsigned int uDstRate);
+
+// frees the filter bank and any buffered audio
+void shutdown();
+
+// Queues 'uSamples' stereo samples (4 bytes each) of source audio.
+void push(const Uint8 *pu8Src, unsigned int uSamples);
+
+// Writes up to 'uSamples' stereo samples at the destination rate to 'pu8Dst'.
+// Returns how many samples were written; if this is less than 'uSamples',
+// more source audio must be pushed before the rest can be produced.
+unsigned int pull(Uint8 *pu8Dst, unsigned int uSamples);
+
+// how many milliseconds of delay the filter adds
+double get_delay_ms();
+}
+
+#endif // RESAMPLE_H
@@ -5,6 +5,7 @@
 #include "../game/game.h" // to get sound names
 #include "../io/conout.h"
 #include "../io/mpo_mem.h" // for endian-independent macros
+#include "mix.h"
 #include "samples.h"
 #include <string.h> // for memset
 #include <plog/Log.h>
@@ -102,29 +103,29 @@ void get_stream(Uint8 *stream, int length, int unused)
         data_s *data = &g_SampleStates[u];
 
         if (data->bActive) {
-            Uint8 *ptrStream = stream;
-
-            // do each sample
-            for (unsigned int uSample = 0; uSample < uTotalSamples; ++uSample) {
-                // if there is still some sample data to be mixed to this stream
-                if (data->uPos < data->uLength) {
-                    int iMixedSample1 = LOAD_LIL_SINT16((Sint16 *)ptrStream);
-                    int iMixedSample2 = LOAD_LIL_SINT16(((Sint16 *)ptrStream) + 1);
-
-                    Sint16 i16Sample1 = LOAD_LIL_SINT16(data->pu8Buf + data->uPos);
-                    iMixedSample1 += i16Sample1;
-                    data->uPos += 2;
-
-                    // if this is a stereo sample
-                    if (data->uChannels == 2) {
-                        iMixedSample2 += LOAD_LIL_SINT16(data->pu8Buf + data->uPos);
-                        data->uPos += 2;
-                    }
-                    // else this is a mono sample, so just duplicate the last
-                    // sample we read in
-                    else {
-                        iMixedSample2 += i16Sample1;
-                    }
+            // how many 4-byte (stereo) samples this entry still has to give
+            unsigned int uBytesPerSample = data->uChannels << 1;
+            unsigned int uSamplesLeft    = (data->uLength - data->uPos) / uBytesPerSample;
+            unsigned int uSamples        = uSamplesLeft;
+
+            if (uSamples > uTotalSamples) {
+                uSamples = uTotalSamples;
+            }
+
+            // stereo samples are already in the same layout as the stream, so
+            // the whole block can be added at once
+            if (data->uChannels == 2) {
+                mix_add_s16(stream, data->pu8Buf + data->uPos, uSamples << 1);
+            }
+            // else this is a mono sample, so each value goes to both channels
+            else {
+                Uint8 *ptrStream = stream;
+                const Uint8 *ptrSample = data->pu8Buf + data->uPos;
+
+                for (unsigned int uSample = 0; uSample < uSamples; ++uSample) {
+                    Sint16 i16Sample = LOAD_LIL_SINT16(ptrSample);
+                    int iMixedSample1 = LOAD_LIL_SINT16((Sint16 *)ptrStream) + i16Sample;
+                    int iMixedSample2 = LOAD_LIL_SINT16(((Sint16 *)ptrStream) + 1) + i16Sample;
 
                     DO_CLIP(iMixedSample1); // prevent overflow
                     DO_CLIP(iMixedSample2);
@@ -135,31 +136,52 @@ void get_stream(Uint8 *stream, int length, int unused)
                         (((Uint16)iMixedSample2) << 16) | (Uint16)iMixedSample1;
                     STORE_LIL_UINT32(ptrStream, val_to_store);
                     ptrStream += 4;
+                    ptrSample += 2;
                 }
-                // else this sample is done, so get rid of the entry ...
-                else {
-                    data->bActive = false;
-
-                    // if caller has requested to be notified when this sample
-                    // is done ...
-                    if (data->finishedCallback != NULL) {
-                        callback_s cb;
-                        cb.finishedCallback = data->finishedCallback;
-                        cb.pu8Buf           = data->pu8Buf;
-                        cb.uSampleIdx       = u;
-
-                        // NOTE : I am _assuming_ the SDL_LockAudio has already
-                        // been called which is why I don't do it here.
-                        // The callback needs to be queued up so that the main
-                        // thread can issue it (the audio thread can't issue it
-                        // without causing instability)
-                        g_qCallbacks.push(cb);
-                    }
-                    break;
+            }
+
+            data->uPos += uSamples * uBytesPerSample;
+
+            // if this sample is done, get rid of the entry ...
+            if (uSamples == uSamplesLeft) {
+                data->bActive = false;
+
+                // if caller has requested to be notified when this sample
+                // is done ...
+                if (data->finishedCallback != NULL) {
+                    callback_s cb;
+                    cb.finishedCallback = data->finishedCallback;
+                    cb.pu8Buf           = data->pu8Buf;
+                    cb.uSampleIdx       = u;
+
+                    // NOTE : I am _assuming_ the SDL_LockAudio has already
+                    // been called which is why I don't do it here.
+                    // The callback needs to be queued up so that the main
+                    // thread can issue it (the audio thread can't issue it
+                    // without causing instability)
+                    g_qCallbacks.push(cb);
                 }
-            } // end going through stream buffer
-        }     // end while we have states to be addressed
-    }         // end looping through all sample slots
+            }
+        } // end if this slot is active
+    }     // end looping through all sample slots
+}
+
+Uint8 *mono_to_stereo(const Uint8 *pu8Buf, unsigned int uLength)
+{
+    Uint8 *pu8Result = (Uint8 *)SDL_malloc(uLength << 1);
+
+    if (pu8Result) {
+        Uint8 *ptrDst = pu8Result;
+
+        for (unsigned int u = 0; u + 1 < uLength; u += 2) {
+            // copy the raw bytes so this works regardless of endianness
+            ptrDst[0] = ptrDst[2] = pu8Buf[u];
+            ptrDst[1] = ptrDst[3] = pu8Buf[u + 1];
+            ptrDst += 4;
+        }
+    }
+
+    return pu8Result;
 }
 
 int play(Uint8 *pu8Buf, unsigned int uLength,
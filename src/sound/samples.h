@@ -37,12 +37,18 @@ void shutdown(int shutdown);
 // called from sound mixer to get audio stream
 void get_stream(Uint8 *stream, int length, int internal_id);
 
+// Converts a mono 16-bit sample to the stereo layout that the mixer works in
+// natively, so that it can be mixed a whole block at a time.
+// Returns a buffer twice as long as 'uLength' (or NULL if out of memory) which
+// must be freed with SDL_free (SDL_FreeWAV is fine too).
+Uint8 *mono_to_stereo(const Uint8 *pu8Buf, unsigned int uLength);
+
 // Plays a sample
 // The sample's audio specs must match our the audio device's specs
 // 'uLength' is how long the sample is IN BYTES (so 4-bytes = 1 sample for
 // 16-bit stereo)
 // 'uChannels' is how many channels the sample has (must be 1 for mono or 2 for
-// stereo)
+// stereo; stereo is mixed much faster, see mono_to_stereo)
 // 'iSlot' specifies which slot to play the sample in, or -1 to just pick the
 // next available one
 // Returns the slot that the sample is playing in, or
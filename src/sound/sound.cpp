@@ -46,10 +46,14 @@
 #include "gisound.h"
 #include "mix.h"
 #include "pc_beeper.h"
+#include "resample.h"
 #include "samples.h"
 #include "sn_intf.h"
 #include "sound.h"
 #include "tonegen.h"
+#include "wavwriter.h"
+#include <map>
+#include <string>
 
 namespace sound
 {
@@ -80,6 +84,57 @@ Uint16 g_u16SoundBufSamples = 2048;
 // # of bytes each individual sound chip should be allocated for its buffer
 unsigned int g_uSoundChipBufSize = g_u16SoundBufSamples * BYTES_PER_SAMPLE;
 
+// true when the audio device runs at a different rate than FREQ and we convert
+// to it ourselves
+bool g_bResampling = false;
+
+// one chip buffer's worth of mixed audio at FREQ, waiting to be resampled
+Uint8 *g_pu8MixBuf = NULL;
+
+// rough time (in ms) between a sound chip producing audio and it being heard
+double g_dLatencyMs = 0.0;
+
+// Adaptive buffering: start with a small device buffer and grow it whenever the
+// device runs dry (or we can't mix fast enough), shrink it again after a long
+// enough stretch without trouble.
+bool g_bAdaptive = false;
+static const Uint16 ADAPT_MIN_SAMPLES = 256;
+static const Uint16 ADAPT_MAX_SAMPLES = 8192;
+static const Uint16 ADAPT_START_SAMPLES = 512;
+
+// how long (in seconds) the buffer must be trouble free before we try a smaller
+// one.  Doubled every time a smaller buffer turns out to be too small, so we
+// settle down instead of bouncing back and forth.
+unsigned int g_uAdaptShrinkSecs = 30;
+unsigned int g_uAdaptQuietSecs  = 0;
+Uint32 g_uAdaptLastCheck        = 0;
+unsigned int g_uAdaptLastTrouble = 0;
+bool g_bAdaptJustShrunk         = false;
+
+// telemetry, updated by the audio callback (protected by LOCK_AUDIO)
+stats_s g_stats = {0, 0, 0, 0, 0.0};
+
+// for detecting when the device has played more than we have given it
+Uint64 g_u64CallbackStart = 0; // performance counter at the first callback
+Uint64 g_u64Delivered     = 0; // samples handed to the device since then
+
+// a callback that takes longer than this many performance counter ticks is
+// eating too much of the buffer period
+Uint64 g_u64OverrunTicks = 0;
+
+// Offline rendering (-audio_render): no audio device is opened, instead
+// update_buffer() mixes a buffer whenever the emulation clock has produced
+// enough audio for one, and writes it to g_strRenderFile.  With
+// g_bRenderStems, each sound chip's unmixed output also goes to its own file.
+bool g_bRendering = false;
+bool g_bRenderStems = false;
+string g_strRenderFile;
+wavwriter::wav_s g_render_wav = {NULL, 0};
+std::map<unsigned int, wavwriter::wav_s> g_render_stems; // by chip id
+
+// emulated time since the last mix, in 1/1000ths of a sample
+Uint32 g_uRenderAcc = 0;
+
 // the volume (user adjustable) of the VLDP audio stream
 unsigned int g_uVolumeVLDP = MAX_VOLUME;
 
@@ -137,18 +192,296 @@ void set_buf_size(Uint16 newbufsize)
         cur->bytes_left     = g_uSoundChipBufSize;
         cur                 = cur->next;
     }
+
+    if (g_pu8MixBuf) {
+        delete[] g_pu8MixBuf;
+        g_pu8MixBuf = new Uint8[g_uSoundChipBufSize];
+    }
 }
 
 static SDL_AudioSpec specDesired, specObtained;
 
+void set_adaptive(bool bAdaptive) { g_bAdaptive = bAdaptive; }
+
+// Sizes the chip buffers to fit the device buffer that was just opened and
+// works out the resulting latency.
+// IMPORTANT : the audio callback must not be running!
+static void size_chip_buffers()
+{
+    if (g_bResampling) {
+        // the chips need just enough audio at FREQ to fill one device buffer
+        // (rounded up to an even count for the mixing functions)
+        unsigned int uSrcSamples =
+            ((specObtained.samples * FREQ + specObtained.freq - 1) / specObtained.freq + 1) & ~1;
+        set_buf_size(uSrcSamples);
+        if (!g_pu8MixBuf) {
+            g_pu8MixBuf = new Uint8[g_uSoundChipBufSize];
+        }
+    } else {
+        set_buf_size(specObtained.samples);
+    }
+
+    double dDeviceMs = specObtained.samples * 1000.0 / specObtained.freq;
+
+    // audio is generated up to one chip buffer ahead of being mixed, then
+    // waits out one device buffer
+    g_dLatencyMs = dDeviceMs +
+                   (g_uSoundChipBufSize * 1000.0) / (FREQ * BYTES_PER_SAMPLE) +
+                   (g_bResampling ? resample::get_delay_ms() : 0.0);
+
+    g_stats.uBufSamples = specObtained.samples;
+    g_stats.dLatencyMs  = g_dLatencyMs;
+
+    // a callback may use up to 3/4 of its period before we call it an overrun
+    g_u64OverrunTicks  = (SDL_GetPerformanceFrequency() * specObtained.samples * 3) /
+                         (specObtained.freq * 4);
+    g_u64CallbackStart = 0;
+
+    if (!g_bRendering) {
+        LOGI << fmt("Audio device: %d Hz, %u sample buffer, approx. %.1f ms latency",
+                    specObtained.freq, specObtained.samples, g_dLatencyMs);
+    }
+}
+
+// Opens the audio device with specDesired.  If it comes back at a rate our
+// resampler can't handle, the device is opened again at FREQ and SDL is left
+// to do the conversion.
+static bool open_device()
+{
+    if (SDL_OpenAudio(&specDesired, &specObtained) < 0) {
+        return false;
+    }
+
+    g_bResampling = false;
+    if (specObtained.freq == FREQ) {
+        return true;
+    }
+
+    if (resample::init(FREQ, specObtained.freq)) {
+        g_bResampling = true;
+        return true;
+    }
+
+    LOGI << fmt("Cannot resample to %d Hz, letting SDL convert instead", specObtained.freq);
+    SDL_CloseAudio();
+
+    specDesired.freq = FREQ;
+
+    // with no 'obtained' spec, SDL converts to the device format itself and
+    // fills in specDesired with what it settled on
+    if (SDL_OpenAudio(&specDesired, NULL) < 0) {
+        return false;
+    }
+    specObtained = specDesired;
+
+    return true;
+}
+
+// Closes the audio device and opens it again with a 'u16Samples' buffer.
+// Used by adaptive buffering; must be called from the main thread.
+static bool reopen_device(Uint16 u16Samples)
+{
+    bool bResult = false;
+
+    SDL_CloseAudio(); // stops the callback too
+
+    specDesired.freq    = specObtained.freq;
+    specDesired.samples = u16Samples;
+
+    // the rate shouldn't change, but this restarts the resampler either way
+    // so it doesn't hold on to audio from before
+    if (open_device()) {
+        size_chip_buffers();
+        SDL_PauseAudio(0);
+        bResult = true;
+    }
+
+    if (!bResult) {
+        LOGE << fmt("Audio device could not be re-opened: %s", SDL_GetError());
+        g_sound_enabled = false;
+        g_bAdaptive     = false;
+    }
+
+    return bResult;
+}
+
+// Looks at the telemetry once a second and resizes the device buffer if it
+// needs to be.
+static void adapt()
+{
+    Uint32 uNow = SDL_GetTicks();
+
+    if ((uNow - g_uAdaptLastCheck) < 1000) {
+        return;
+    }
+    g_uAdaptLastCheck = uNow;
+
+    LOCK_AUDIO();
+    unsigned int uTrouble = g_stats.uUnderruns + g_stats.uOverruns;
+    UNLOCK_AUDIO();
+
+    Uint16 u16Samples = specObtained.samples;
+
+    // trouble since the last check, so we need more room
+    if (uTrouble != g_uAdaptLastTrouble) {
+        g_uAdaptLastTrouble = uTrouble;
+        g_uAdaptQuietSecs   = 0;
+
+        // if we only just made it smaller, that was a mistake so wait longer
+        // before trying again
+        if (g_bAdaptJustShrunk) {
+            g_uAdaptShrinkSecs <<= 1;
+        }
+        g_bAdaptJustShrunk = false;
+
+        if (u16Samples < ADAPT_MAX_SAMPLES) {
+            LOGI << fmt("Audio is stuttering, growing buffer to %u samples",
+                        u16Samples << 1);
+            reopen_device(u16Samples << 1);
+        }
+    }
+    // things have been quiet for long enough, so see if we can get away with
+    // a smaller buffer
+    else if (++g_uAdaptQuietSecs >= g_uAdaptShrinkSecs) {
+        g_uAdaptQuietSecs = 0;
+        g_bAdaptJustShrunk = false;
+
+        if (u16Samples > ADAPT_MIN_SAMPLES) {
+            LOGI << fmt("Audio is stable, shrinking buffer to %u samples",
+                        u16Samples >> 1);
+            g_bAdaptJustShrunk = reopen_device(u16Samples >> 1);
+        }
+    }
+}
+
+void set_render_file(const char *szPath, bool bStems)
+{
+    g_bRendering    = true;
+    g_bRenderStems  = bStems;
+    g_strRenderFile = szPath;
+}
+
+// loads the waves, adds the 'samples' chip and initializes all the sound chips
+static bool start_chips()
+{
+    // if we can't load all our waves, we're not set
+    if (!load_waves()) {
+        LOGW << "ERROR: one or more required sound sample "
+                "files could not be loaded!";
+        return false;
+    }
+
+    // If we are supposed to start without playing any sound, then set muted
+    // bool here.
+    // It must come here because add_chip (which comes right afterwards) will
+    // set the sound mixing callback.
+    if (get_startsilent()) {
+        g_bSoundMuted = true;
+    }
+
+    // right before initialization, add the samples 'sound chip', which can
+    // (and should be) only added once, so we need not track its ID (we call
+    // its functions directly)
+    struct chip soundchip;
+    soundchip.type = CHIP_SAMPLES;
+    add_chip(&soundchip);
+
+    // initialize sound chips
+    init_chip();
+
+    return true;
+}
+
+// sets things up to render to g_strRenderFile instead of opening a device
+static bool init_render()
+{
+    if (!start_chips()) {
+        return false;
+    }
+
+    if (!wavwriter::open(g_render_wav, g_strRenderFile.c_str(), FREQ, CHANNELS)) {
+        return false;
+    }
+
+    // pretend we got a device running at FREQ so the chip buffers get sized
+    // as usual
+    specObtained.freq     = FREQ;
+    specObtained.channels = CHANNELS;
+    specObtained.format   = FORMAT;
+    specObtained.samples  = g_u16SoundBufSamples;
+    specObtained.callback = callback;
+
+    g_bAdaptive = false; // there is nothing to adapt to
+    size_chip_buffers();
+    g_pu8MixBuf = new Uint8[g_uSoundChipBufSize];
+    g_uRenderAcc = 0;
+
+    LOGI << fmt("Rendering audio to %s", g_strRenderFile.c_str());
+    return true;
+}
+
+// returns the stem file for 'cur', creating it if this is the first time
+static wavwriter::wav_s &get_stem(struct chip *cur)
+{
+    static const char *szNames[] = {"undefined", "samples", "vldp",
+                                    "sn76496", "ay-3-8910", "beeper",
+                                    "dac", "tonegen"};
+
+    std::map<unsigned int, wavwriter::wav_s>::iterator i = g_render_stems.find(cur->id);
+
+    if (i == g_render_stems.end()) {
+        wavwriter::wav_s &wav = g_render_stems[cur->id];
+        string strPath = g_strRenderFile;
+        string::size_type uDot = strPath.rfind('.');
+
+        // out.wav becomes out-0-samples.wav
+        if (uDot != string::npos) {
+            strPath.erase(uDot);
+        }
+        strPath += "-" + numstr::ToStr(cur->id) + "-" + szNames[cur->type] + ".wav";
+
+        wav.F = NULL;
+        wavwriter::open(wav, strPath.c_str(), FREQ, CHANNELS);
+        return wav;
+    }
+
+    return i->second;
+}
+
+// Called once per emulated millisecond when rendering; mixes and writes out a
+// buffer each time enough time has passed for one.
+static void render_tick()
+{
+    const Uint32 uBufUnits = (g_uSoundChipBufSize / BYTES_PER_SAMPLE) * 1000;
+
+    g_uRenderAcc += FREQ;
+
+    while (g_uRenderAcc >= uBufUnits) {
+        g_uRenderAcc -= uBufUnits;
+
+        mix(g_pu8MixBuf, g_uSoundChipBufSize);
+        wavwriter::write(g_render_wav, g_pu8MixBuf, g_uSoundChipBufSize);
+
+        // mix() leaves each chip's output in its buffer, so grab it for the
+        // stems before it gets overwritten
+        if (g_bRenderStems) {
+            for (struct chip *cur = g_chip_head; cur; cur = cur->next) {
+                wavwriter::write(get_stem(cur), cur->buffer, g_uSoundChipBufSize);
+            }
+        }
+    }
+}
+
 bool init()
 // returns a true on success, false on failure
 {
 
     bool result    = false;
-    int audio_rate = FREQ; // rate to mix audio at.  This cannot be
-                           // changed without resampling all .wav's and
-                           // all .ogg's
+    int audio_rate = FREQ; // rate to open the device at.  We always mix at
+                           // FREQ (changing that would mean resampling all
+                           // .wav's and all .ogg's), but if the device
+                           // prefers another rate we convert to it
+                           // ourselves rather than let SDL do it.
 
     Uint16 audio_format = FORMAT;
     int audio_channels  = CHANNELS;
@@ -157,13 +490,27 @@ bool init()
 
     // if the user has not disabled sound from the command line
     if (is_enabled()) {
+        // rendering to a file, so we don't want an audio device
+        if (g_bRendering) {
+            if (init_render()) {
+                result              = true;
+                g_sound_initialized = true;
+            }
+        }
         // if SDL audio initialization was successful
-        if (SDL_InitSubSystem(SDL_INIT_AUDIO) >= 0) {
+        else if (SDL_InitSubSystem(SDL_INIT_AUDIO) >= 0) {
+#if SDL_VERSION_ATLEAST(2, 24, 0)
+            SDL_AudioSpec specDevice;
+            if ((SDL_GetDefaultAudioInfo(NULL, &specDevice, 0) == 0) &&
+                (specDevice.freq > 0)) {
+                audio_rate = specDevice.freq;
+            }
+#endif
             specDesired.callback = callback;
             specDesired.channels = audio_channels;
             specDesired.format   = audio_format;
             specDesired.freq     = audio_rate;
-            specDesired.samples  = g_u16SoundBufSamples;
+            specDesired.samples  = g_bAdaptive ? ADAPT_START_SAMPLES : g_u16SoundBufSamples;
             specDesired.userdata = NULL;
 
             // this stuff doesn't need to be filled in supposedly ...
@@ -171,46 +518,26 @@ bool init()
             specDesired.size    = 0;
 
             // if we can open the audio device
-            if (SDL_OpenAudio(&specDesired, &specObtained) >= 0) {
+            if (open_device()) {
                 // make sure we got what we asked for
+                // (open_device deals with SDL handing us a different rate)
                 if ((specObtained.channels == audio_channels) &&
                     (specObtained.format == audio_format) &&
-                    (specObtained.freq == audio_rate) &&
                     (specObtained.callback == callback)) {
                     // if we can load all our waves, we're set
-                    if (load_waves()) {
-                        // If we are supposed to start without playing any
-                        // sound, then set muted bool here.
-                        // It must come here because add_chip (which comes
-                        // right afterwards) will set the sound mixing callback.
-                        if (get_startsilent()) {
-                            g_bSoundMuted = true;
-                        }
-
-                        // right before initialization, add the samples 'sound
-                        // chip', which can (and should be)
-                        //  only added once, so we need not track its ID (we
-                        //  call its functions directly)
-                        struct chip soundchip;
-                        soundchip.type = CHIP_SAMPLES;
-                        add_chip(&soundchip);
-
-                        // initialize sound chips
-                        init_chip();
-
-                        if (specObtained.samples != g_u16SoundBufSamples) {
+                    if (start_chips()) {
+                        if (specObtained.samples != specDesired.samples) {
                             string strWarning =
                                 "WARNING : requested " +
-                                numstr::ToStr(g_u16SoundBufSamples) +
+                                numstr::ToStr(specDesired.samples) +
                                 " samples for sound buffer, but got " +
                                 numstr::ToStr(specObtained.samples) +
                                 " samples";
                             LOGW << strWarning;
-
-                            // reset memory allocations
-                            set_buf_size(specObtained.samples);
                         }
 
+                        size_chip_buffers();
+
                         result              = true;
                         g_sound_initialized = true;
 
@@ -218,15 +545,12 @@ bool init()
                         // be safe)
                         SDL_PauseAudio(0); // start mixing! :)
                     }
-                    // else if loading waves failed
-                    else {
-                        LOGW << "ERROR: one or more required sound sample "
-                                "files could not be loaded!";
-                    }
                 } // end if audio specs are correct
                 else {
                     LOGW << "ERROR: unable to obtain desired audio "
                             "configuration";
+                    resample::shutdown();
+                    g_bResampling = false;
                 }
             } // end if audio device could be opened ...
 
@@ -253,12 +577,39 @@ void shutdown()
     // shutdown sound only if we previously initialized it
     if (g_sound_initialized) {
         LOGD << "Shutting down sound system...";
+        if (g_stats.uUnderruns || g_stats.uOverruns || g_stats.uChipOverflows) {
+            LOGI << fmt("Audio: %u underruns, %u overruns, %u chip overflows, "
+                        "%u sample buffer",
+                        g_stats.uUnderruns, g_stats.uOverruns,
+                        g_stats.uChipOverflows, g_stats.uBufSamples);
+        }
         SDL_PauseAudio(1);
         SDL_CloseAudio();
         free_waves();
         shutdown_chip();
+        resample::shutdown();
+        g_bResampling = false;
+        if (g_pu8MixBuf) {
+            delete[] g_pu8MixBuf;
+            g_pu8MixBuf = NULL;
+        }
         g_sound_initialized = 0;
-        SDL_QuitSubSystem(SDL_INIT_AUDIO);
+
+        if (g_bRendering) {
+            LOGI << fmt("Rendered %u ms of audio to %s",
+                        (unsigned int)(((Uint64)g_render_wav.uDataBytes * 1000) /
+                                       (FREQ * BYTES_PER_SAMPLE)),
+                        g_strRenderFile.c_str());
+            wavwriter::close(g_render_wav);
+
+            std::map<unsigned int, wavwriter::wav_s>::iterator i;
+            for (i = g_render_stems.begin(); i != g_render_stems.end(); ++i) {
+                wavwriter::close(i->second);
+            }
+            g_render_stems.clear();
+        } else {
+            SDL_QuitSubSystem(SDL_INIT_AUDIO);
+        }
     }
 }
 
@@ -284,13 +635,31 @@ bool play_saveme()
     bool result = false;
 
     if (is_enabled()) {
-		samples::play(g_sample_saveme.pu8Buf, g_sample_saveme.uLength);
+		samples::play(g_sample_saveme.pu8Buf, g_sample_saveme.uLength,
+                      g_sample_saveme.uChannels);
         result = true;
     }
 
     return result;
 }
 
+// converts a freshly loaded mono wave to stereo so the sample mixer can add
+// it a whole block at a time
+void make_stereo(sample_s &sample)
+{
+    if (sample.uChannels == 1) {
+        Uint8 *pu8Stereo = samples::mono_to_stereo(sample.pu8Buf, sample.uLength);
+
+        // if we run out of memory, the mono wave still plays (just slower)
+        if (pu8Stereo) {
+            SDL_FreeWAV(sample.pu8Buf);
+            sample.pu8Buf    = pu8Stereo;
+            sample.uLength <<= 1;
+            sample.uChannels = 2;
+        }
+    }
+}
+
 // loads the wave files into the wave structure
 // returns 0 if failure, or non-zero if success
 int load_waves()
@@ -316,6 +685,7 @@ int load_waves()
             if (((spec.channels == CHANNELS) || (spec.channels == 1)) &&
                 (spec.freq == FREQ) && (spec.format == AUDIO_S16)) {
                 g_samples[i].uChannels = spec.channels;
+                make_stereo(g_samples[i]);
             }
             // else specs are not correct
             else {
@@ -334,8 +704,11 @@ int load_waves()
     }
 
     // load "saveme" sound in
-    if (!SDL_LoadWAV("sound/saveme.wav", &spec, &g_sample_saveme.pu8Buf,
-                     &g_sample_saveme.uLength)) {
+    if (SDL_LoadWAV("sound/saveme.wav", &spec, &g_sample_saveme.pu8Buf,
+                    &g_sample_saveme.uLength)) {
+        g_sample_saveme.uChannels = spec.channels;
+        make_stereo(g_sample_saveme);
+    } else {
         LOGW << "Loading 'saveme.wav' failed...";
         result = 0;
     }
@@ -661,7 +1034,7 @@ void mixWithMults(Uint8 *stream, int length)
     }
 }
 
-void callback(void *data, Uint8 *stream, int length)
+void mix(Uint8 *stream, int length)
 {
     // now go through the sound chips and mix them in
     struct chip *cur = g_chip_head;
@@ -682,6 +1055,63 @@ void callback(void *data, Uint8 *stream, int length)
     g_soundmix_callback(stream, length);
 }
 
+void callback(void *data, Uint8 *stream, int length)
+{
+    Uint64 u64Now = SDL_GetPerformanceCounter();
+    unsigned int uDeviceSamples = length / BYTES_PER_SAMPLE;
+
+    // Has the device played more than we've given it (plus one buffer of
+    // slack)?  If so, it ran dry and the user heard a gap.
+    if (g_u64CallbackStart != 0) {
+        Uint64 u64Played = ((u64Now - g_u64CallbackStart) * specObtained.freq) /
+                           SDL_GetPerformanceFrequency();
+
+        if (u64Played > g_u64Delivered + uDeviceSamples) {
+            ++g_stats.uUnderruns;
+            g_u64Delivered = u64Played; // start counting afresh
+        }
+    } else {
+        g_u64CallbackStart = u64Now;
+        g_u64Delivered     = 0;
+    }
+    g_u64Delivered += uDeviceSamples;
+
+    // if the device runs at its own rate, mix whole chip buffers at FREQ and
+    // let the resampler stretch them to fit
+    if (g_bResampling) {
+        unsigned int uSamples = length / BYTES_PER_SAMPLE;
+        unsigned int uDone    = resample::pull(stream, uSamples);
+
+        while (uDone < uSamples) {
+            mix(g_pu8MixBuf, g_uSoundChipBufSize);
+            resample::push(g_pu8MixBuf, g_uSoundChipBufSize / BYTES_PER_SAMPLE);
+            uDone += resample::pull(stream + (uDone * BYTES_PER_SAMPLE), uSamples - uDone);
+        }
+    } else {
+        mix(stream, length);
+    }
+
+    if ((SDL_GetPerformanceCounter() - u64Now) > g_u64OverrunTicks) {
+        ++g_stats.uOverruns;
+    }
+}
+
+void get_stats(stats_s &stats)
+{
+    LOCK_AUDIO();
+    stats = g_stats;
+    UNLOCK_AUDIO();
+}
+
+void think()
+{
+    if (g_bAdaptive && g_sound_initialized) {
+        adapt();
+    }
+}
+
+double get_latency_ms() { return g_dLatencyMs; }
+
 void writedata(Uint8 id, Uint8 data)
 {
     // if sound isn't initialized, then the chips aren't initialized either
@@ -875,11 +1305,22 @@ void update_buffer()
                 }
                 // else we throw away the new data
                 // should we handle this some other way?
+                else {
+                    ++g_stats.uChipOverflows;
+                }
             }
             // else doesn't need to be updated so often, so don't do it ...
             cur = cur->next;
         }
+
+        // when rendering, the emulation clock drives the mixer instead of the
+        // audio device
+        if (g_bRendering) {
+            render_tick();
+        }
         UNLOCK_AUDIO();
+
+        think();
     }
 }
 }
@@ -64,6 +64,26 @@ enum {
     CHIP_TONEGEN
 };
 
+// audio telemetry, see get_stats()
+struct stats_s {
+    // times the device played out everything we gave it before asking for
+    // more (an audible gap)
+    unsigned int uUnderruns;
+
+    // times the audio callback used up most of a buffer period just mixing
+    unsigned int uOverruns;
+
+    // times a sound chip generated more audio than its buffer could hold and
+    // some had to be thrown away
+    unsigned int uChipOverflows;
+
+    // current size of the device buffer, in samples
+    unsigned int uBufSamples;
+
+    // see get_latency_ms()
+    double dLatencyMs;
+};
+
 struct sample_s {
     // how many channels (1 = mono, 2 = stereo) that this sample has
     unsigned int uChannels;
@@ -185,6 +205,15 @@ void mixWithMaxVolume(Uint8 *stream, int length);
 void mixWithMults(Uint8 *stream, int length);
 
 void callback(void *, Uint8 *, int); // audio callback for SDLMixer
+
+// Fills every sound chip's buffer and mixes them into 'stream' at FREQ.
+// 'length' must be the size of the chip buffers.  callback() uses this
+// directly, or through the resampler if the device runs at another rate.
+void mix(Uint8 *stream, int length);
+
+// approximate time in milliseconds from a sound being generated to it coming
+// out of the audio device (valid once init() has succeeded)
+double get_latency_ms();
 void writedata(Uint8, Uint8);
 
 // for game driver to send commands to sound chip
@@ -220,11 +249,31 @@ void update_chip_volumes();
 void shutdown_chip();
 void update_buffer(); // update the sound buffers with 1 ms worth of data
 void set_buf_size(Uint16 newbufsize);
+
+// Adaptive buffering (-sound_adaptive): the device buffer starts small and is
+// resized as the underrun/overrun counters dictate.  Must be set before init().
+void set_adaptive(bool bAdaptive);
+
+// Gives adaptive buffering a chance to resize the device buffer.
+// Called from update_buffer(), or by the LDP for games without an emulated CPU.
+void think();
+
+// copies the audio counters into 'stats'
+void get_stats(stats_s &stats);
+
+// Render the mixed audio to the .wav file 'szPath' instead of playing it
+// (-audio_render).  update_buffer() then drives the mixer from the emulation
+// clock, so the output is the same no matter how fast the emulator runs.
+// If 'bStems' is set, each sound chip's output is also written to its own file
+// alongside.  Must be called before init().
+void set_render_file(const char *szPath, bool bStems);
+
 bool init();
 void shutdown();
 bool play(Uint32 whichone);
 bool play_saveme();
 int load_waves();
+void make_stereo(sample_s &sample); // mono waves get converted at load time
 void free_waves();
 int get_initialized();
 void set_mute(bool bMuted); // added by JFA for -startsilent
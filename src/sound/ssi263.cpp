@@ -47,6 +47,8 @@
 #include "ssi263.h"
 #include "tqsynth.h"
 #include <string.h>
+#include <map>
+#include <string>
 #include <plog/Log.h>
 
 #ifdef SSI_REG_DEBUG
@@ -75,6 +77,26 @@ static thayers *m_thayers = NULL;     // Need to call into the TQ class to
 
 // Forward declarations of local funtions.
 void say_phones(char *phonemes, int len);
+void finished_callback_uncached(Uint8 *pu8Buf, unsigned int uSlot);
+
+// Thayer's Quest repeats the same handful of phrases over and over, so keep
+// every rendered phrase around (keyed by its rsynth phoneme string) instead of
+// running the Klatt synthesizer again.
+typedef std::map<std::string, sound::sample_s> phrase_cache;
+static phrase_cache m_phrase_cache;
+static unsigned int m_phrase_cache_bytes = 0;
+
+// Upper limit on how much rendered speech we are willing to hold on to.
+// The whole game fits comfortably in this; anything past it is synthesized
+// and freed as before.
+static const unsigned int SSI_CACHE_MAX_BYTES = 16 * 1024 * 1024;
+
+// The cached phrase the mixer is playing right now (if any), and whether
+// shutdown() left it for finished_callback to free.
+static Uint8 *m_playing_buf = NULL;
+static bool m_free_playing  = false;
+
+bool g_bSamplePlaying = false;
 
 // Duration/Phoneme
 // Working theory: top 2 bits are for duration, the rest is for the phoneme
@@ -378,45 +400,113 @@ bool init(bool init_speech)
     return result;
 }
 
-bool g_bSamplePlaying = false;
+// Release every cached phrase.
+void shutdown()
+{
+    for (phrase_cache::iterator i = m_phrase_cache.begin();
+         i != m_phrase_cache.end(); ++i) {
+        // a phrase that is still playing belongs to the mixer until it
+        // finishes, so leave that one to finished_callback
+        if (g_bSamplePlaying && (i->second.pu8Buf == m_playing_buf)) {
+            m_free_playing = true;
+        } else {
+            tqsynth::free_chunk(i->second.pu8Buf);
+        }
+    }
+    m_phrase_cache.clear();
+    m_phrase_cache_bytes = 0;
+
+    m_speech_enabled = false;
+}
+
+// Starts playback of a rendered phrase, keeping it in the cache if it fits.
+// Returns the sample slot, or a negative number if the mixer had no room.
+static int play_phrase(const std::string &phones, const sound::sample_s &phrase, bool bFromCache)
+{
+    bool bCached = bFromCache;
+
+    if (!bCached && (m_phrase_cache_bytes + phrase.uLength <= SSI_CACHE_MAX_BYTES)) {
+        m_phrase_cache[phones] = phrase;
+        m_phrase_cache_bytes += phrase.uLength;
+        bCached = true;
+    }
+
+    g_bSamplePlaying = true; // so that we don't overlap samples (only
+                             // happens at the very beginning of boot-up)
+    int iSlot = samples::play(phrase.pu8Buf, phrase.uLength, sound::CHANNELS, -1,
+                              bCached ? finished_callback : finished_callback_uncached);
+
+    // don't wait for a callback that will never come
+    if (iSlot < 0) {
+        LOGW << "no sample slot available for speech";
+        g_bSamplePlaying = false;
+        if (!bCached) {
+            tqsynth::free_chunk(phrase.pu8Buf);
+        }
+    } else if (bCached) {
+        m_playing_buf = phrase.pu8Buf;
+    }
+
+    return iSlot;
+}
 
 // Take phoneme text and ship it off to get turned into a speech wavefile. We
 // request a raw waveform because it provides an opportunity exercise a little
 // more control over the playback (could have done this in the tqsynth code,
 // but wanted tqsynth to be somewhat independent of the Hypseus code).
+// Phrases we have already rendered are played straight from the cache; a new
+// phrase is still synthesized right here, since the ROM is held until the
+// speech has finished playing anyway.
 void say_phones(char *phonemes, int len)
 {
-    sound::sample_s the_sample;
-
-    the_sample.pu8Buf  = NULL;
-    the_sample.uLength = 0;
-
-    if (tqsynth::phones_to_wave(phonemes, len, &the_sample)) {
-        g_bSamplePlaying = true; // so that we don't overlap samples (only
-                                 // happens at the very beginning of boot-up)
-        samples::play(the_sample.pu8Buf, the_sample.uLength,
-                      sound::CHANNELS, -1, finished_callback);
-
-        // Wait for sample to stop playing
-        // NOTE : This is a hack and isn't proper emulation.
-        // The proper fix to this is to return to the ROM some signal that our
-        // sample has finished playing.
-        while ((g_bSamplePlaying) && (!get_quitflag())) {
-            samples::do_queued_callbacks(); // hack to ensure sound callbacks are
-                                            // called in a thread-safe way.  In
-                                            // the next major version, this hack
-                                            // must be done away with.
-            SDL_Delay(10);
-            SDL_check_input();
-        }
+    std::string phones(phonemes, len);
 
+    phrase_cache::iterator i = m_phrase_cache.find(phones);
+
+    if (i != m_phrase_cache.end()) {
+        play_phrase(phones, i->second, true);
     } else {
-        LOGE << "phones_to_wave procedure failed";
+        sound::sample_s the_sample;
+
+        the_sample.pu8Buf  = NULL;
+        the_sample.uLength = 0;
+
+        if (tqsynth::phones_to_wave(phonemes, len, &the_sample)) {
+            play_phrase(phones, the_sample, false);
+        } else {
+            LOGE << "phones_to_wave procedure failed";
+        }
+    }
+
+    // Wait for sample to stop playing
+    // NOTE : This is a hack and isn't proper emulation.
+    // The proper fix to this is to return to the ROM some signal that our
+    // sample has finished playing.
+    while ((g_bSamplePlaying) && (!get_quitflag())) {
+        samples::do_queued_callbacks(); // hack to ensure sound callbacks are
+                                        // called in a thread-safe way.  In
+                                        // the next major version, this hack
+                                        // must be done away with.
+        SDL_Delay(10);
+        SDL_check_input();
     }
 }
 
-// gets called when sample has finished playing
+// gets called when a cached sample has finished playing
 void finished_callback(Uint8 *pu8Buf, unsigned int uSlot)
+{
+    g_bSamplePlaying = false;
+    m_playing_buf    = NULL;
+
+    // the cache was emptied while we were playing
+    if (m_free_playing) {
+        tqsynth::free_chunk(pu8Buf);
+        m_free_playing = false;
+    }
+}
+
+// gets called when a sample that didn't fit in the cache has finished playing
+void finished_callback_uncached(Uint8 *pu8Buf, unsigned int uSlot)
 {
     g_bSamplePlaying = false;
     tqsynth::free_chunk(pu8Buf);
@@ -38,5 +38,6 @@ void reg2(unsigned char value);
 void reg3(unsigned char value);
 void reg4(unsigned char value);
 bool init(bool init_speech);
+void shutdown();
 void finished_callback(Uint8 *pu8Buf, unsigned int uSlot);
 }
@@ -0,0 +1,93 @@
+/*
+ * ____ DAPHNE COPYRIGHT NOTICE ____
+ *
+ * This file is part of DAPHNE, a laserdisc arcade game emulator
+ *
+ * DAPHNE is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * DAPHNE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// wavwriter.cpp
+
+#include "config.h"
+
+#include "../io/conout.h"
+#include "../io/mpo_mem.h"
+#include "wavwriter.h"
+#include <string.h>
+#include <plog/Log.h>
+
+namespace wavwriter
+{
+// canonical 44 byte RIFF header with a single 'fmt ' and 'data' chunk
+static const unsigned int HEADER_SIZE = 44;
+
+bool open(wav_s &wav, const char *szPath, unsigned int uFreq, unsigned int uChannels)
+{
+    Uint8 u8Header[HEADER_SIZE];
+    unsigned int uBlockAlign = uChannels * 2;
+
+    wav.uDataBytes = 0;
+    wav.F          = fopen(szPath, "wb");
+
+    if (!wav.F) {
+        LOGW << fmt("Could not create %s", szPath);
+        return false;
+    }
+
+    // the sizes get filled in by close() once we know them
+    memcpy(u8Header, "RIFF", 4);
+    STORE_LIL_UINT32(u8Header + 4, 0);
+    memcpy(u8Header + 8, "WAVEfmt ", 8);
+    STORE_LIL_UINT32(u8Header + 16, 16);        // fmt chunk size
+    STORE_LIL_UINT16(u8Header + 20, 1);         // PCM
+    STORE_LIL_UINT16(u8Header + 22, uChannels);
+    STORE_LIL_UINT32(u8Header + 24, uFreq);
+    STORE_LIL_UINT32(u8Header + 28, uFreq * uBlockAlign); // bytes per second
+    STORE_LIL_UINT16(u8Header + 32, uBlockAlign);
+    STORE_LIL_UINT16(u8Header + 34, 16);        // bits per sample
+    memcpy(u8Header + 36, "data", 4);
+    STORE_LIL_UINT32(u8Header + 40, 0);
+
+    fwrite(u8Header, 1, HEADER_SIZE, wav.F);
+    return true;
+}
+
+void write(wav_s &wav, const Uint8 *pu8Buf, unsigned int uBytes)
+{
+    if (wav.F) {
+        wav.uDataBytes += fwrite(pu8Buf, 1, uBytes, wav.F);
+    }
+}
+
+void close(wav_s &wav)
+{
+    Uint8 u8Size[4];
+
+    if (!wav.F) {
+        return;
+    }
+
+    STORE_LIL_UINT32(u8Size, wav.uDataBytes + HEADER_SIZE - 8);
+    fseek(wav.F, 4, SEEK_SET);
+    fwrite(u8Size, 1, 4, wav.F);
+
+    STORE_LIL_UINT32(u8Size, wav.uDataBytes);
+    fseek(wav.F, 40, SEEK_SET);
+    fwrite(u8Size, 1, 4, wav.F);
+
+    fclose(wav.F);
+    wav.F = NULL;
+}
+}
@@ -0,0 +1,49 @@
+/*
+ * ____ DAPHNE COPYRIGHT NOTICE ____
+ *
+ * This file is part of DAPHNE, a laserdisc arcade game emulator
+ *
+ * DAPHNE is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * DAPHNE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// wavwriter.h
+// Writes 16-bit PCM audio to .wav files, used to render the mixer output to
+// disk (-audio_render).
+
+#ifndef WAVWRITER_H
+#define WAVWRITER_H
+
+#include <SDL.h> // for data-type defs
+#include <stdio.h>
+
+namespace wavwriter
+{
+struct wav_s {
+    FILE *F;
+    Uint32 uDataBytes; // how much audio has been written so far
+};
+
+// Creates 'szPath' and writes a header for 16-bit audio at 'uFreq' Hz with
+// 'uChannels' channels.  Returns false if the file couldn't be created.
+bool open(wav_s &wav, const char *szPath, unsigned int uFreq, unsigned int uChannels);
+
+// Appends 'uBytes' of little-endian 16-bit audio.
+void write(wav_s &wav, const Uint8 *pu8Buf, unsigned int uBytes);
+
+// Fills in the sizes in the header and closes the file.
+void close(wav_s &wav);
+}
+
+#endif // WAVWRITER_H
@@ -0,0 +1,245 @@
+/*
+ * ____ DAPHNE COPYRIGHT NOTICE ____
+ *
+ * Copyright (C) 2001 Matt Ownby
+ *
+ * This file is part of DAPHNE, a laserdisc arcade game emulator
+ *
+ * DAPHNE is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * DAPHNE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// capture.cpp
+// Screenshot and frame capture writer.  Surfaces are queued to a writer
+// thread which encodes and saves them; screenshot numbers are kept in
+// screenshots/.counter, and -capture png|raw saves every presented frame.
+
+#include "config.h"
+
+#include "../io/conout.h"
+#include "../io/mpo_fileio.h"
+#include "capture.h"
+#include "video.h" // for PATH_SEPARATOR
+#include <SDL_image.h>
+#include <deque>
+#include <plog/Log.h>
+#include <stdio.h>
+#include <string>
+
+using namespace std;
+
+namespace capture
+{
+// how many surfaces can be waiting to be written.  A full HD frame is 8 MB,
+// so this is kept small; if the disk can't keep up, frames get dropped.
+static const unsigned int MAX_QUEUED = 8;
+
+static const char DIR[] = "screenshots";
+
+struct job_s {
+    SDL_Surface *surface;
+    string strPath;
+    bool bRaw;
+    unsigned int uNextShot; // to save to the counter file afterwards (0 = don't)
+};
+
+int g_continuous = CAPTURE_OFF;
+
+SDL_Thread *g_thread = NULL;
+SDL_mutex *g_mutex   = NULL;
+SDL_cond *g_cond     = NULL;
+deque<job_s> g_queue;
+bool g_quit = false;
+
+// next screenshot number (0 until we've read it from the counter file)
+unsigned int g_uNextShot = 0;
+
+// continuous capture session number and frame count
+unsigned int g_uSession  = 0;
+unsigned int g_uFrameNum = 0;
+unsigned int g_uDropped  = 0;
+
+void set_continuous(int mode) { g_continuous = mode; }
+int get_continuous() { return g_continuous; }
+
+static string counter_path() { return string(DIR) + PATH_SEPARATOR + ".counter"; }
+
+// Hands out the next free screenshot number, reading the counter file (or,
+// the first time ever, probing for existing screenshots) if we haven't yet.
+static unsigned int next_number()
+{
+    char filename[64];
+
+    if (g_uNextShot == 0) {
+        FILE *F = fopen(counter_path().c_str(), "r");
+        if (F) {
+            if (fscanf(F, "%u", &g_uNextShot) != 1) g_uNextShot = 0;
+            fclose(F);
+        }
+        if (g_uNextShot == 0) g_uNextShot = 1;
+    }
+
+    // skip past anything that's been put there since (this normally only
+    // probes once)
+    for (;;) {
+        snprintf(filename, sizeof(filename), "%s%shypseus-%u.png", DIR,
+                 PATH_SEPARATOR, g_uNextShot);
+        if (!mpo_file_exists(filename)) break;
+        g_uNextShot++;
+    }
+
+    return g_uNextShot++;
+}
+
+static void write_counter(unsigned int uNext)
+{
+    FILE *F = fopen(counter_path().c_str(), "w");
+    if (F) {
+        fprintf(F, "%u\n", uNext);
+        fclose(F);
+    }
+}
+
+static void write_raw(SDL_Surface *surface, const char *szPath)
+{
+    FILE *F = fopen(szPath, "wb");
+    if (!F) {
+        LOGE << fmt("Could not write frame: %s", szPath);
+        return;
+    }
+    for (int row = 0; row < surface->h; row++) {
+        fwrite((Uint8 *)surface->pixels + (row * surface->pitch), 1,
+               surface->w * surface->format->BytesPerPixel, F);
+    }
+    fclose(F);
+}
+
+static int writer_thread(void *)
+{
+    SDL_LockMutex(g_mutex);
+
+    for (;;) {
+        while (g_queue.empty() && !g_quit) SDL_CondWait(g_cond, g_mutex);
+        if (g_queue.empty()) break; // quitting with nothing left to do
+
+        job_s job = g_queue.front();
+        g_queue.pop_front();
+        SDL_UnlockMutex(g_mutex);
+
+        if (job.bRaw) {
+            write_raw(job.surface, job.strPath.c_str());
+        } else if (IMG_SavePNG(job.surface, job.strPath.c_str()) != 0) {
+            LOGE << fmt("Could not write screenshot: %s !!", job.strPath.c_str());
+        } else if (g_continuous == CAPTURE_OFF) {
+            LOGI << fmt("Wrote screenshot: %s", job.strPath.c_str());
+        }
+        SDL_FreeSurface(job.surface);
+
+        if (job.uNextShot) write_counter(job.uNextShot);
+
+        SDL_LockMutex(g_mutex);
+    }
+
+    SDL_UnlockMutex(g_mutex);
+    return 0;
+}
+
+static bool queue(SDL_Surface *surface, const string &strPath, bool bRaw,
+                  unsigned int uNextShot)
+{
+    if (!g_thread) {
+        g_mutex  = SDL_CreateMutex();
+        g_cond   = SDL_CreateCond();
+        g_quit   = false;
+        g_thread = SDL_CreateThread(writer_thread, "capture", NULL);
+        if (!g_thread) {
+            LOGE << fmt("Could not start capture thread: %s", SDL_GetError());
+            SDL_FreeSurface(surface);
+            return false;
+        }
+    }
+
+    SDL_LockMutex(g_mutex);
+    bool bResult = (g_queue.size() < MAX_QUEUED);
+    if (bResult) {
+        job_s job = {surface, strPath, bRaw, uNextShot};
+        g_queue.push_back(job);
+        SDL_CondSignal(g_cond);
+    }
+    SDL_UnlockMutex(g_mutex);
+
+    if (!bResult) {
+        SDL_FreeSurface(surface);
+        g_uDropped++;
+    }
+    return bResult;
+}
+
+bool queue_screenshot(SDL_Surface *surface)
+{
+    char filename[64];
+
+    unsigned int uNum = next_number();
+
+    snprintf(filename, sizeof(filename), "%s%shypseus-%u.png", DIR, PATH_SEPARATOR, uNum);
+
+    if (!queue(surface, filename, false, g_uNextShot)) {
+        LOGW << "Screenshot dropped, still busy writing the last ones";
+        return false;
+    }
+    return true;
+}
+
+bool queue_frame(SDL_Surface *surface)
+{
+    char filename[64];
+    bool bRaw = (g_continuous == CAPTURE_RAW);
+
+    // each capture gets a number of its own from the screenshot counter
+    if (g_uSession == 0) {
+        g_uSession = next_number();
+        write_counter(g_uNextShot);
+
+        LOGI << fmt("Capturing %dx%d frames to %s%scapture%u-*.%s", surface->w,
+                    surface->h, DIR, PATH_SEPARATOR, g_uSession,
+                    bRaw ? "raw (32-bit XRGB)" : "png");
+    }
+
+    snprintf(filename, sizeof(filename), "%s%scapture%u-%06u.%s", DIR,
+             PATH_SEPARATOR, g_uSession, g_uFrameNum++, bRaw ? "raw" : "png");
+
+    return queue(surface, filename, bRaw, 0);
+}
+
+void shutdown()
+{
+    if (g_thread) {
+        SDL_LockMutex(g_mutex);
+        g_quit = true;
+        SDL_CondSignal(g_cond);
+        SDL_UnlockMutex(g_mutex);
+        SDL_WaitThread(g_thread, NULL);
+        g_thread = NULL;
+
+        SDL_DestroyCond(g_cond);
+        SDL_DestroyMutex(g_mutex);
+        g_cond  = NULL;
+        g_mutex = NULL;
+    }
+
+    if (g_uFrameNum) {
+        LOGI << fmt("Captured %u frames (%u dropped)", g_uFrameNum - g_uDropped, g_uDropped);
+    }
+}
+}
@@ -0,0 +1,52 @@
+/*
+ * ____ DAPHNE COPYRIGHT NOTICE ____
+ *
+ * Copyright (C) 2001 Matt Ownby
+ *
+ * This file is part of DAPHNE, a laserdisc arcade game emulator
+ *
+ * DAPHNE is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * DAPHNE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// capture.h
+// Writes screenshots and captured frames out on a thread of their own, so
+// that PNG encoding and disk access don't hold up the emulation.
+
+#ifndef CAPTURE_H
+#define CAPTURE_H
+
+#include <SDL.h>
+
+namespace capture
+{
+enum { CAPTURE_OFF, CAPTURE_PNG, CAPTURE_RAW };
+
+// -capture png|raw : write every presented frame to the screenshots directory
+void set_continuous(int mode);
+int get_continuous();
+
+// Queues 'surface' to be written out as the next numbered screenshot.
+// We take ownership of the surface either way; returns false if it had to be
+// dropped because the queue was full.
+bool queue_screenshot(SDL_Surface *surface);
+
+// same, but as the next frame of a continuous capture
+bool queue_frame(SDL_Surface *surface);
+
+// waits for everything queued to be written and stops the writer thread
+void shutdown();
+}
+
+#endif // CAPTURE_H
@@ -45,6 +45,28 @@ t_yuv_color *g_yuv = NULL;
 
 bool g_modified = true;
 
+// set when an RGB value has changed and g_yuv hasn't caught up yet
+bool g_yuv_stale = false;
+
+// Brings g_yuv up to date with g_rgb.  Palette writes tend to come in bursts
+// (a driver rewriting its whole palette), so all the colors are converted in
+// one go rather than one at a time in set_color().
+static void update_yuv()
+{
+    if (!g_yuv_stale) return;
+
+    Uint8 y[256], u[256], v[256];
+    rgb2yuv_buf((const Uint8 *)g_rgb, y, u, v, g_size);
+
+    for (unsigned int x = 0; x < g_size; x++) {
+        g_yuv[x].y = y[x];
+        g_yuv[x].u = u[x];
+        g_yuv[x].v = v[x];
+    }
+
+    g_yuv_stale = false;
+}
+
 // call this function once to set size of game palette
 bool initialize(unsigned int num_colors)
 {
@@ -115,8 +137,8 @@ void set_color(unsigned int color_num, SDL_Color color_value)
     assert(color_num < g_size);
 #endif
 
-    // make sure the color has really been modified because the RGB2YUV
-    // calculations are expensive
+    // make sure the color has really been modified, so the surfaces' palettes
+    // only get reloaded when something changed
     if ((g_rgb[color_num].r != color_value.r) ||
         (g_rgb[color_num].g != color_value.g) ||
         (g_rgb[color_num].b != color_value.b)) {
@@ -130,21 +152,16 @@ void set_color(unsigned int color_num, SDL_Color color_value)
                                     color_value.r | (color_value.g << 8) |
                                     (color_value.b << 16);
 
-        // MATT : seems to make more sense to calculate the YUV value of the
-        // color here
-        rgb2yuv_input[0] = g_rgb[color_num].r;
-        rgb2yuv_input[1] = g_rgb[color_num].g;
-        rgb2yuv_input[2] = g_rgb[color_num].b;
-        rgb2yuv();
-        g_yuv[color_num].y = rgb2yuv_result_y;
-        g_yuv[color_num].v = rgb2yuv_result_v;
-        g_yuv[color_num].u = rgb2yuv_result_u;
+        // the YUV value gets calculated by update_yuv()
+        g_yuv_stale = true;
     }
 }
 
 // call this function right before drawing the current overlay
 void finalize()
 {
+    update_yuv();
+
     if (g_modified) {
         // update color palette for all the surfaces that we are using
         for (int i = 0;; i++) {
@@ -179,11 +196,18 @@ void shutdown(void)
         delete[] g_yuv;
         g_yuv = NULL;
     }
+    g_yuv_stale = false;
 }
 
 // this function is here temporarily while the game drivers are switch to this
 // new method
-t_yuv_color *get_yuv(void) { return g_yuv; }
+t_yuv_color *get_yuv(void)
+{
+    update_yuv();
+    return g_yuv;
+}
+
+unsigned int get_color_count(void) { return g_size; }
 
 Uint32 *get_rgba(void) { return g_uRGBAPalette; }
 }
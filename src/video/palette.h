@@ -20,6 +20,11 @@
  * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  */
 
+#ifndef PALETTE_H
+#define PALETTE_H
+
+#include <SDL.h>
+
 namespace palette
 {
 typedef struct {
@@ -45,5 +50,10 @@ void set_color(unsigned int color_num, SDL_Color color_value);
 void finalize();
 void shutdown(void);
 t_yuv_color *get_yuv(void);
+
+// the number of colors passed to initialize()
+unsigned int get_color_count(void);
 Uint32 *get_rgba(void);
 }
+
+#endif
@@ -23,6 +23,16 @@
 #include "config.h"
 
 #include "rgb2yuv.h"
+#include <string.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
 
 // if we aren't using the assembly version, then use the C version instead
 #ifndef USE_MMX
@@ -317,3 +327,153 @@ void rgb2yuv()
 */
 
 #endif // not MMX_RGB2YUV
+
+////////////////////////////////////////////////////////////////////////////
+
+// Same formula as rgb2yuv() above: the chroma products can be negative, and
+// are shifted arithmetically like the lookup tables do.
+static inline void rgb2yuv_pixel(const Uint8 *p, Uint8 *pY, Uint8 *pU, Uint8 *pV)
+{
+    int r = p[0], g = p[1], b = p[2];
+    int y = ((9798 * r) + (19235 * g) + (3736 * b)) >> 15;
+
+    *pY = (Uint8)y;
+    *pU = (Uint8)((((b - y) * 18514) >> 15) + 128);
+    *pV = (Uint8)((((r - y) * 23364) >> 15) + 128);
+}
+
+void rgb2yuv_buf_c(const Uint8 *pRGBX, Uint8 *pY, Uint8 *pU, Uint8 *pV, unsigned int uCount)
+{
+    for (unsigned int u = 0; u < uCount; u++) {
+        rgb2yuv_pixel(pRGBX + (u << 2), pY + u, pU + u, pV + u);
+    }
+}
+
+#if defined(__SSE2__)
+// Each 32-bit lane holds one pixel (R in the low byte).  madd does the
+// multiplies: Y's three products come out as two sums per pixel, and for U
+// and V the signed 16-bit difference sits alone in the low half of its lane.
+static inline __m128i rgb2yuv_sse2_y(__m128i px)
+{
+    const __m128i kY = _mm_set_epi16(0, 3736, 19235, 9798, 0, 3736, 19235, 9798);
+    __m128i zero     = _mm_setzero_si128();
+    __m128 lo        = _mm_castsi128_ps(_mm_madd_epi16(_mm_unpacklo_epi8(px, zero), kY));
+    __m128 hi        = _mm_castsi128_ps(_mm_madd_epi16(_mm_unpackhi_epi8(px, zero), kY));
+    __m128i rg       = _mm_castps_si128(_mm_shuffle_ps(lo, hi, _MM_SHUFFLE(2, 0, 2, 0)));
+    __m128i b        = _mm_castps_si128(_mm_shuffle_ps(lo, hi, _MM_SHUFFLE(3, 1, 3, 1)));
+    return _mm_srli_epi32(_mm_add_epi32(rg, b), 15);
+}
+
+static inline __m128i rgb2yuv_sse2_chroma(__m128i c, __m128i y, int iMul)
+{
+    __m128i diff = _mm_sub_epi32(c, y);
+    // only the low 16 bits of each lane take part, the high half multiplies by 0
+    diff = _mm_and_si128(diff, _mm_set1_epi32(0xFFFF));
+    return _mm_add_epi32(_mm_srai_epi32(_mm_madd_epi16(diff, _mm_set1_epi32(iMul)), 15),
+                         _mm_set1_epi32(128));
+}
+
+static inline int rgb2yuv_sse2_pack(__m128i v)
+{
+    v = _mm_packs_epi32(v, v);
+    return _mm_cvtsi128_si32(_mm_packus_epi16(v, v));
+}
+#endif
+
+void rgb2yuv_buf(const Uint8 *pRGBX, Uint8 *pY, Uint8 *pU, Uint8 *pV, unsigned int uCount)
+{
+    unsigned int u = 0;
+
+#if defined(__SSE2__)
+    const __m128i kByte = _mm_set1_epi32(0xFF);
+
+#ifdef __AVX2__
+    const __m256i kY = _mm256_set_epi16(0, 3736, 19235, 9798, 0, 3736, 19235, 9798,
+                                        0, 3736, 19235, 9798, 0, 3736, 19235, 9798);
+    const __m256i kByte8 = _mm256_set1_epi32(0xFF);
+    const __m256i kLow16 = _mm256_set1_epi32(0xFFFF);
+    const __m256i k128   = _mm256_set1_epi32(128);
+
+    // same as the SSE2 version, 8 pixels at a time (the lanes stay in order
+    // within each 128-bit half)
+    for (; u + 8 <= uCount; u += 8) {
+        __m256i px   = _mm256_loadu_si256((const __m256i *)(pRGBX + (u << 2)));
+        __m256i zero = _mm256_setzero_si256();
+        __m256 lo    = _mm256_castsi256_ps(_mm256_madd_epi16(_mm256_unpacklo_epi8(px, zero), kY));
+        __m256 hi    = _mm256_castsi256_ps(_mm256_madd_epi16(_mm256_unpackhi_epi8(px, zero), kY));
+        __m256i y    = _mm256_srli_epi32(
+            _mm256_add_epi32(_mm256_castps_si256(_mm256_shuffle_ps(lo, hi, _MM_SHUFFLE(2, 0, 2, 0))),
+                             _mm256_castps_si256(_mm256_shuffle_ps(lo, hi, _MM_SHUFFLE(3, 1, 3, 1)))),
+            15);
+        __m256i r = _mm256_and_si256(px, kByte8);
+        __m256i b = _mm256_and_si256(_mm256_srli_epi32(px, 16), kByte8);
+        __m256i cu = _mm256_and_si256(_mm256_sub_epi32(b, y), kLow16);
+        __m256i cv = _mm256_and_si256(_mm256_sub_epi32(r, y), kLow16);
+        cu = _mm256_add_epi32(_mm256_srai_epi32(_mm256_madd_epi16(cu, _mm256_set1_epi32(18514)), 15), k128);
+        cv = _mm256_add_epi32(_mm256_srai_epi32(_mm256_madd_epi16(cv, _mm256_set1_epi32(23364)), 15), k128);
+
+        __m256i planes[3] = {y, cu, cv};
+        Uint8 *dst[3]     = {pY + u, pU + u, pV + u};
+        for (int i = 0; i < 3; i++) {
+            __m256i w = _mm256_packs_epi32(planes[i], planes[i]);
+            w         = _mm256_packus_epi16(w, w);
+            int lo4   = _mm_cvtsi128_si32(_mm256_castsi256_si128(w));
+            int hi4   = _mm_cvtsi128_si32(_mm256_extracti128_si256(w, 1));
+            memcpy(dst[i], &lo4, 4);
+            memcpy(dst[i] + 4, &hi4, 4);
+        }
+    }
+#endif
+
+    for (; u + 4 <= uCount; u += 4) {
+        __m128i px = _mm_loadu_si128((const __m128i *)(pRGBX + (u << 2)));
+        __m128i y  = rgb2yuv_sse2_y(px);
+        __m128i r  = _mm_and_si128(px, kByte);
+        __m128i b  = _mm_and_si128(_mm_srli_epi32(px, 16), kByte);
+
+        int iY = rgb2yuv_sse2_pack(y);
+        int iU = rgb2yuv_sse2_pack(rgb2yuv_sse2_chroma(b, y, 18514));
+        int iV = rgb2yuv_sse2_pack(rgb2yuv_sse2_chroma(r, y, 23364));
+        memcpy(pY + u, &iY, 4);
+        memcpy(pU + u, &iU, 4);
+        memcpy(pV + u, &iV, 4);
+    }
+#elif defined(__ARM_NEON)
+    for (; u + 8 <= uCount; u += 8) {
+        uint8x8x4_t px = vld4_u8(pRGBX + (u << 2)); // splits R, G, B and the rest
+        uint16x8_t r   = vmovl_u8(px.val[0]);
+        uint16x8_t g   = vmovl_u8(px.val[1]);
+        uint16x8_t b   = vmovl_u8(px.val[2]);
+        uint16x4_t y16[2], u16[2], v16[2];
+
+        for (int half = 0; half < 2; half++) {
+            uint16x4_t r4 = half ? vget_high_u16(r) : vget_low_u16(r);
+            uint16x4_t g4 = half ? vget_high_u16(g) : vget_low_u16(g);
+            uint16x4_t b4 = half ? vget_high_u16(b) : vget_low_u16(b);
+
+            uint32x4_t acc = vmull_n_u16(r4, 9798);
+            acc            = vmlal_n_u16(acc, g4, 19235);
+            acc            = vmlal_n_u16(acc, b4, 3736);
+            int32x4_t y    = vreinterpretq_s32_u32(vshrq_n_u32(acc, 15));
+
+            int32x4_t cu = vsubq_s32(vreinterpretq_s32_u32(vmovl_u16(b4)), y);
+            int32x4_t cv = vsubq_s32(vreinterpretq_s32_u32(vmovl_u16(r4)), y);
+            cu = vaddq_s32(vshrq_n_s32(vmulq_n_s32(cu, 18514), 15), vdupq_n_s32(128));
+            cv = vaddq_s32(vshrq_n_s32(vmulq_n_s32(cv, 23364), 15), vdupq_n_s32(128));
+
+            y16[half] = vmovn_u32(vreinterpretq_u32_s32(y));
+            u16[half] = vmovn_u32(vreinterpretq_u32_s32(cu));
+            v16[half] = vmovn_u32(vreinterpretq_u32_s32(cv));
+        }
+
+        vst1_u8(pY + u, vmovn_u16(vcombine_u16(y16[0], y16[1])));
+        vst1_u8(pU + u, vmovn_u16(vcombine_u16(u16[0], u16[1])));
+        vst1_u8(pV + u, vmovn_u16(vcombine_u16(v16[0], v16[1])));
+    }
+#endif
+
+    // whatever is left over (or everything, if there is no SIMD available)
+    for (; u < uCount; u++) {
+        rgb2yuv_pixel(pRGBX + (u << 2), pY + u, pU + u, pV + u);
+    }
+}
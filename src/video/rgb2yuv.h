@@ -25,6 +25,8 @@
 
 #include "config.h"
 
+#include <SDL.h>
+
 #ifdef USE_MMX
 
 #define rgb2yuv asm_rgb2yuv
@@ -67,6 +69,16 @@ extern unsigned int rgb2yuv_result_v; // 8-bit
 
 #endif
 
+// Converts 'uCount' pixels laid out as R, G, B and one unused byte (SDL_Color,
+// or the overlay's RGBA palette entries) to separate Y, U and V values.
+// Uses SSE2/AVX2/NEON when the build targets them; the results are the same
+// as rgb2yuv_buf_c().
+void rgb2yuv_buf(const Uint8 *pRGBX, Uint8 *pY, Uint8 *pU, Uint8 *pV, unsigned int uCount);
+
+// The plain C version of rgb2yuv_buf.  Always built, so releasetest can check
+// the SIMD version against it.
+void rgb2yuv_buf_c(const Uint8 *pRGBX, Uint8 *pY, Uint8 *pU, Uint8 *pV, unsigned int uCount);
+
 /////////////////////////////
 
 #endif
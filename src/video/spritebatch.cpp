@@ -0,0 +1,216 @@
+/*
+ * ____ DAPHNE COPYRIGHT NOTICE ____
+ *
+ * This file is part of DAPHNE, a laserdisc arcade game emulator
+ *
+ * DAPHNE is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * DAPHNE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// spritebatch.cpp
+
+#include "config.h"
+
+#include "spritebatch.h"
+#include "../io/conout.h"
+#include <plog/Log.h>
+#include <map>
+#include <vector>
+
+using namespace std;
+
+namespace spritebatch
+{
+struct cmd_s {
+    SDL_Surface *pSurface; // (we hold a reference)
+    int x, y;
+    SDL_BlendMode mode;
+};
+
+struct texture_s {
+    SDL_Texture *pTexture;
+    bool bKeyed;     // the surface's color key when the texture was made
+    Uint32 uKey;
+    Uint32 uLastUsed; // frame number
+};
+
+// textures not drawn for this many frames get freed
+static const Uint32 TEXTURE_MAX_AGE = 300;
+
+bool g_bEnabled = false;
+
+vector<cmd_s> g_queued; // being drawn by Singe
+vector<cmd_s> g_shown;  // what goes on screen
+
+// One texture per surface.  Each entry holds a reference on its surface so
+// the pointer can't be reused for another surface while it's in here.
+map<SDL_Surface *, texture_s> g_textures;
+Uint32 g_uFrame = 0;
+
+void set_enabled(bool bEnabled) { g_bEnabled = bEnabled; }
+
+bool is_enabled() { return g_bEnabled; }
+
+static void release(vector<cmd_s> &cmds)
+{
+    for (size_t i = 0; i < cmds.size(); i++) {
+        SDL_FreeSurface(cmds[i].pSurface);
+    }
+    cmds.clear();
+}
+
+void add(SDL_Surface *pSurface, const SDL_Rect &dst, SDL_BlendMode mode)
+{
+    cmd_s cmd;
+    cmd.pSurface = pSurface;
+    cmd.x        = dst.x;
+    cmd.y        = dst.y;
+    cmd.mode     = mode;
+
+    pSurface->refcount++;
+    g_queued.push_back(cmd);
+}
+
+unsigned int size() { return (unsigned int)g_queued.size(); }
+
+bool overlaps(const SDL_Rect &r)
+{
+    for (size_t i = 0; i < g_queued.size(); i++) {
+        const cmd_s &cmd = g_queued[i];
+        SDL_Rect rc      = {cmd.x, cmd.y, cmd.pSurface->w, cmd.pSurface->h};
+        if (SDL_HasIntersection(&rc, &r)) return true;
+    }
+    return false;
+}
+
+void clear() { release(g_queued); }
+
+void bake(SDL_Surface *pDst)
+{
+    for (size_t i = 0; i < g_queued.size(); i++) {
+        const cmd_s &cmd = g_queued[i];
+        SDL_Rect dst     = {cmd.x, cmd.y, cmd.pSurface->w, cmd.pSurface->h};
+        SDL_BlendMode old;
+
+        SDL_GetSurfaceBlendMode(cmd.pSurface, &old);
+        SDL_SetSurfaceBlendMode(cmd.pSurface, cmd.mode);
+        SDL_BlitSurface(cmd.pSurface, NULL, pDst, &dst);
+        SDL_SetSurfaceBlendMode(cmd.pSurface, old);
+    }
+    release(g_queued);
+}
+
+void publish()
+{
+    release(g_shown);
+    g_shown = g_queued;
+    for (size_t i = 0; i < g_shown.size(); i++) {
+        g_shown[i].pSurface->refcount++;
+    }
+}
+
+// the texture for 'pSurface', made (or remade, if its color key has changed)
+// if need be
+static SDL_Texture *get_texture(SDL_Renderer *pRenderer, SDL_Surface *pSurface)
+{
+    Uint32 uKey = 0;
+    bool bKeyed = (SDL_GetColorKey(pSurface, &uKey) == 0);
+
+    map<SDL_Surface *, texture_s>::iterator i = g_textures.find(pSurface);
+    if (i != g_textures.end()) {
+        if ((i->second.bKeyed == bKeyed) && (i->second.uKey == uKey)) {
+            i->second.uLastUsed = g_uFrame;
+            return i->second.pTexture;
+        }
+        SDL_DestroyTexture(i->second.pTexture);
+        SDL_FreeSurface(pSurface);
+        g_textures.erase(i);
+    }
+
+    texture_s tex;
+    tex.pTexture = SDL_CreateTextureFromSurface(pRenderer, pSurface);
+    if (!tex.pTexture) {
+        LOGW << fmt("Could not make a sprite texture: %s", SDL_GetError());
+        return NULL;
+    }
+
+    tex.bKeyed    = bKeyed;
+    tex.uKey      = uKey;
+    tex.uLastUsed = g_uFrame;
+
+    pSurface->refcount++;
+    g_textures[pSurface] = tex;
+    return tex.pTexture;
+}
+
+void draw(SDL_Renderer *pRenderer, const SDL_Rect &area)
+{
+    g_uFrame++;
+
+    if (!g_shown.empty() && area.w && area.h) {
+        SDL_Rect vp;
+        SDL_RenderGetViewport(pRenderer, &vp);
+        double dScaleX = (double)vp.w / area.w;
+        double dScaleY = (double)vp.h / area.h;
+
+        // SDL batches consecutive copies into as few GPU calls as it can
+        for (size_t i = 0; i < g_shown.size(); i++) {
+            const cmd_s &cmd  = g_shown[i];
+            SDL_Texture *pTex = get_texture(pRenderer, cmd.pSurface);
+            if (!pTex) continue;
+
+            int x1 = (int)((cmd.x - area.x) * dScaleX);
+            int y1 = (int)((cmd.y - area.y) * dScaleY);
+            int x2 = (int)((cmd.x - area.x + cmd.pSurface->w) * dScaleX);
+            int y2 = (int)((cmd.y - area.y + cmd.pSurface->h) * dScaleY);
+            SDL_Rect dst = {x1, y1, x2 - x1, y2 - y1};
+
+            // A NONE blit copied the sprite, alpha and all, into the overlay,
+            // which was then blended over the video.  Where it doesn't land
+            // on another sprite that is the same as blending it straight
+            // over the video; sep_overlay_draw() bakes the ones that do.
+            SDL_SetTextureBlendMode(pTex, (cmd.mode == SDL_BLENDMODE_NONE) ?
+                                    SDL_BLENDMODE_BLEND : cmd.mode);
+            SDL_RenderCopy(pRenderer, pTex, NULL, &dst);
+        }
+    }
+
+    // every so often, let go of textures that have stopped being drawn
+    if ((g_uFrame & 0x3F) == 0) {
+        map<SDL_Surface *, texture_s>::iterator i = g_textures.begin();
+        while (i != g_textures.end()) {
+            if (g_uFrame - i->second.uLastUsed > TEXTURE_MAX_AGE) {
+                SDL_DestroyTexture(i->second.pTexture);
+                SDL_FreeSurface(i->first);
+                g_textures.erase(i++);
+            } else {
+                ++i;
+            }
+        }
+    }
+}
+
+void shutdown()
+{
+    release(g_queued);
+    release(g_shown);
+
+    for (map<SDL_Surface *, texture_s>::iterator i = g_textures.begin();
+         i != g_textures.end(); ++i) {
+        SDL_DestroyTexture(i->second.pTexture);
+        SDL_FreeSurface(i->first);
+    }
+    g_textures.clear();
+}
+}
@@ -0,0 +1,71 @@
+/*
+ * ____ DAPHNE COPYRIGHT NOTICE ____
+ *
+ * This file is part of DAPHNE, a laserdisc arcade game emulator
+ *
+ * DAPHNE is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * DAPHNE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// spritebatch.h
+// Singe's sprites and font strings drawn by the renderer (-gpu_sprites).
+// Instead of blitting into the overlay surface, Singe queues each draw here.
+// Every surface that gets drawn is uploaded to a texture once, and the queue
+// is replayed over the video and overlay each time the frame is presented.
+
+#ifndef SPRITEBATCH_H
+#define SPRITEBATCH_H
+
+#include <SDL.h>
+
+namespace spritebatch
+{
+// the queue gets baked into the overlay surface once it's this long (a script
+// that never clears the overlay would otherwise grow it forever)
+static const unsigned int MAX_QUEUED = 4096;
+
+void set_enabled(bool bEnabled);
+bool is_enabled();
+
+// Queues 'pSurface' to be drawn at 'dst' (overlay coordinates; only x and y
+// are used).  The surface is kept alive until the draw is no longer needed.
+// 'mode' is the blend mode the surface would have been blitted with.
+void add(SDL_Surface *pSurface, const SDL_Rect &dst, SDL_BlendMode mode);
+
+// number of draws queued since the last clear()
+unsigned int size();
+
+// whether anything queued covers part of 'r' (overlay coordinates)
+bool overlaps(const SDL_Rect &r);
+
+// drops everything queued (overlayClear)
+void clear();
+
+// Blits what's queued into 'pDst' and empties the queue, for when something
+// has to be drawn into the overlay surface on top of it.
+void bake(SDL_Surface *pDst);
+
+// Makes what's queued so far the draws that go on screen, until the next
+// publish().  Called when the overlay is repainted.
+void publish();
+
+// Draws the published queue with 'pRenderer', scaling 'area' of the overlay
+// to the viewport the same way the overlay texture is.
+void draw(SDL_Renderer *pRenderer, const SDL_Rect &area);
+
+// frees the textures and lets go of the surfaces (before the renderer goes)
+void shutdown();
+}
+
+#endif
@@ -0,0 +1,135 @@
+/*
+ * ____ DAPHNE COPYRIGHT NOTICE ____
+ *
+ * This file is part of DAPHNE, a laserdisc arcade game emulator
+ *
+ * DAPHNE is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * DAPHNE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// textcache.cpp
+
+#include "config.h"
+
+#include "textcache.h"
+#include <map>
+#include <string>
+
+using namespace std;
+
+namespace textcache
+{
+// Strings that are only shown briefly (scores, timers) would otherwise fill
+// the cache, so the least recently used ones get thrown out past this.
+static const unsigned int MAX_ENTRIES = 512;
+
+struct key_s {
+    TTF_Font *font;
+    int quality;
+    Uint32 fg, bg;
+    string text;
+
+    bool operator<(const key_s &o) const
+    {
+        if (font != o.font) return font < o.font;
+        if (quality != o.quality) return quality < o.quality;
+        if (fg != o.fg) return fg < o.fg;
+        if (bg != o.bg) return bg < o.bg;
+        return text < o.text;
+    }
+};
+
+struct entry_s {
+    SDL_Surface *surface;
+    Uint32 uLastUsed;
+};
+
+typedef map<key_s, entry_s> cache_t;
+
+cache_t g_cache;
+Uint32 g_uUseCount = 0;
+
+static Uint32 pack(SDL_Color c) { return (c.r << 24) | (c.g << 16) | (c.b << 8) | c.a; }
+
+static void evict_oldest()
+{
+    cache_t::iterator oldest = g_cache.begin();
+
+    for (cache_t::iterator i = g_cache.begin(); i != g_cache.end(); ++i) {
+        if (i->second.uLastUsed < oldest->second.uLastUsed) oldest = i;
+    }
+    SDL_FreeSurface(oldest->second.surface);
+    g_cache.erase(oldest);
+}
+
+SDL_Surface *get(TTF_Font *font, int quality, SDL_Color fg, SDL_Color bg,
+                 const char *text)
+{
+    key_s key = {font, quality, pack(fg), pack(bg), text};
+    cache_t::iterator i = g_cache.find(key);
+
+    if (i != g_cache.end()) {
+        i->second.uLastUsed = ++g_uUseCount;
+        return i->second.surface;
+    }
+
+    SDL_Surface *surface = NULL;
+    switch (quality) {
+    case QUALITY_SOLID:
+        surface = TTF_RenderText_Solid(font, text, fg);
+        break;
+    case QUALITY_SHADED:
+        surface = TTF_RenderText_Shaded(font, text, fg, bg);
+        break;
+    case QUALITY_BLENDED:
+        surface = TTF_RenderText_Blended(font, text, fg);
+        break;
+    }
+
+    if (surface) {
+        // done once here rather than on every blit, so the RLE encoding
+        // is kept as well
+        SDL_SetColorKey(surface, SDL_TRUE | SDL_RLEACCEL, 0);
+
+        if (g_cache.size() >= MAX_ENTRIES) evict_oldest();
+
+        entry_s entry = {surface, ++g_uUseCount};
+        g_cache[key] = entry;
+    }
+
+    return surface;
+}
+
+void forget_font(TTF_Font *font)
+{
+    cache_t::iterator i = g_cache.begin();
+
+    while (i != g_cache.end()) {
+        if (i->first.font == font) {
+            SDL_FreeSurface(i->second.surface);
+            g_cache.erase(i++);
+        } else {
+            ++i;
+        }
+    }
+}
+
+void clear()
+{
+    for (cache_t::iterator i = g_cache.begin(); i != g_cache.end(); ++i) {
+        SDL_FreeSurface(i->second.surface);
+    }
+    g_cache.clear();
+}
+}
@@ -0,0 +1,50 @@
+/*
+ * ____ DAPHNE COPYRIGHT NOTICE ____
+ *
+ * This file is part of DAPHNE, a laserdisc arcade game emulator
+ *
+ * DAPHNE is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * DAPHNE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// textcache.h
+// Keeps the surfaces that SDL_ttf renders for strings, so that text which is
+// drawn again every frame (Singe's fontPrint, draw_string) only gets
+// rasterised once.
+
+#ifndef TEXTCACHE_H
+#define TEXTCACHE_H
+
+#include <SDL.h>
+#include <SDL_ttf.h>
+
+namespace textcache
+{
+// quality is Singe's fontQuality: 1 = solid, 2 = shaded, 3 = blended
+enum { QUALITY_SOLID = 1, QUALITY_SHADED, QUALITY_BLENDED };
+
+// Returns 'text' rendered with 'font', colour-keyed on black like Singe does.
+// The surface belongs to the cache and stays valid until the next call, so
+// blit it straight away and don't free it.
+// Returns NULL if SDL_ttf couldn't render it.
+SDL_Surface *get(TTF_Font *font, int quality, SDL_Color fg, SDL_Color bg,
+                 const char *text);
+
+// must be called before closing a font, so nothing is left referring to it
+void forget_font(TTF_Font *font);
+
+void clear();
+}
+
+#endif // TEXTCACHE_H
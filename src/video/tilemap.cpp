@@ -0,0 +1,284 @@
+/*
+ * ____ DAPHNE COPYRIGHT NOTICE ____
+ *
+ * This file is part of DAPHNE, a laserdisc arcade game emulator
+ *
+ * DAPHNE is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * DAPHNE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// tilemap.cpp
+
+#include "config.h"
+
+#include "tilemap.h"
+#include "../io/conout.h"
+#include <plog/Log.h>
+#include <string.h>
+
+tileset::tileset() : m_uCount(0), m_uWidth(0), m_uHeight(0) {}
+
+bool tileset::create(unsigned int uCount, unsigned int uWidth, unsigned int uHeight)
+{
+    if (!uCount || !uWidth || !uHeight) {
+        LOGE << fmt("Bad tileset size %ux%u x %u", uWidth, uHeight, uCount);
+        return false;
+    }
+
+    m_uCount  = uCount;
+    m_uWidth  = uWidth;
+    m_uHeight = uHeight;
+    m_pixels.assign(uCount * uWidth * uHeight, 0);
+    m_flags.assign(uCount, FLAG_EMPTY);
+    return true;
+}
+
+void tileset::finalize()
+{
+    unsigned int uSize = m_uWidth * m_uHeight;
+
+    for (unsigned int n = 0; n < m_uCount; n++) {
+        const Uint8 *p       = get_tile(n);
+        unsigned int uSolid = 0;
+
+        for (unsigned int i = 0; i < uSize; i++) {
+            if (p[i]) uSolid++;
+        }
+
+        m_flags[n] = 0;
+        if (uSolid == 0) m_flags[n] |= FLAG_EMPTY;
+        else if (uSolid == uSize) m_flags[n] |= FLAG_OPAQUE;
+    }
+}
+
+void tileset::draw(SDL_Surface *dst, unsigned int n, int x, int y,
+                   unsigned int uFlags, Uint8 u8Color) const
+{
+    if (n >= m_uCount || is_empty(n)) return;
+
+    // the part of the tile that lands on the surface
+    int xmin = (x < 0) ? -x : 0;
+    int ymin = (y < 0) ? -y : 0;
+    int xmax = dst->w - x;
+    int ymax = dst->h - y;
+    if (xmax > (int)m_uWidth) xmax = m_uWidth;
+    if (ymax > (int)m_uHeight) ymax = m_uHeight;
+    if (xmin >= xmax || ymin >= ymax) return;
+
+    const Uint8 *pTile = get_tile(n);
+
+    for (int row = ymin; row < ymax; row++) {
+        int src_row     = (uFlags & TILE_YFLIP) ? (m_uHeight - 1 - row) : row;
+        const Uint8 *s  = pTile + src_row * m_uWidth;
+        Uint8 *d        = (Uint8 *)dst->pixels + (y + row) * dst->pitch + x;
+
+        if (uFlags & TILE_XFLIP) {
+            for (int col = xmin; col < xmax; col++) {
+                Uint8 p = s[m_uWidth - 1 - col];
+                if (p) d[col] = p + u8Color;
+            }
+        } else {
+            for (int col = xmin; col < xmax; col++) {
+                Uint8 p = s[col];
+                if (p) d[col] = p + u8Color;
+            }
+        }
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////
+
+tilemap::tilemap()
+    : m_pTiles(NULL), m_uCols(0), m_uRows(0), m_uPitchX(0), m_uPitchY(0),
+      m_iOriginX(0), m_iOriginY(0), m_bOverlap(false), m_bDirty(false),
+      m_uLayerW(0), m_uLayerH(0)
+{
+}
+
+bool tilemap::create(const tileset *pTiles, unsigned int uCols, unsigned int uRows,
+                     unsigned int uPitchX, unsigned int uPitchY, int iOriginX, int iOriginY)
+{
+    // rows may not overlap, since they're redrawn one at a time
+    if (!pTiles || !uCols || !uRows || !uPitchX || (uPitchY < pTiles->get_height()) ||
+        (iOriginX < 0) || (iOriginY < 0)) {
+        LOGE << "Bad tilemap layout";
+        return false;
+    }
+
+    m_pTiles   = pTiles;
+    m_uCols    = uCols;
+    m_uRows    = uRows;
+    m_uPitchX  = uPitchX;
+    m_uPitchY  = uPitchY;
+    m_iOriginX = iOriginX;
+    m_iOriginY = iOriginY;
+    m_bOverlap = (uPitchX < pTiles->get_width());
+    m_bDirty   = false;
+
+    m_cells.assign(uCols * uRows, NO_TILE);
+    m_dirty.assign(uCols * uRows, 0);
+    m_state.assign(uCols * uRows, CELL_EMPTY);
+    m_row_empty.assign(uRows, 1);
+
+    m_uLayerW = iOriginX + (uCols - 1) * uPitchX + pTiles->get_width();
+    m_uLayerH = iOriginY + (uRows - 1) * uPitchY + pTiles->get_height();
+    m_layer.assign(m_uLayerW * m_uLayerH, 0);
+    return true;
+}
+
+void tilemap::invalidate()
+{
+    m_dirty.assign(m_dirty.size(), 1);
+    m_bDirty = true;
+}
+
+// draws one cell into the layer (which must have been cleared underneath it)
+void tilemap::draw_cell(unsigned int uCell)
+{
+    Uint32 uKey         = m_cells[uCell];
+    unsigned int uTile  = uKey & 0xFFFF;
+    Uint8 u8Color       = (uKey >> 16) & 0xFF;
+    unsigned int uFlags = uKey >> 24;
+
+    m_dirty[uCell] = 0;
+
+    if ((uKey == NO_TILE) || (uTile >= m_pTiles->get_count()) || m_pTiles->is_empty(uTile)) {
+        m_state[uCell] = CELL_EMPTY;
+        return;
+    }
+    m_state[uCell] = m_pTiles->is_opaque(uTile) ? CELL_OPAQUE : 0;
+
+    unsigned int uW  = m_pTiles->get_width();
+    unsigned int uH  = m_pTiles->get_height();
+    unsigned int uX  = m_iOriginX + (uCell % m_uCols) * m_uPitchX;
+    unsigned int uY  = m_iOriginY + (uCell / m_uCols) * m_uPitchY;
+    const Uint8 *pTile = m_pTiles->get_tile(uTile);
+
+    for (unsigned int row = 0; row < uH; row++) {
+        const Uint8 *s = pTile + ((uFlags & TILE_YFLIP) ? (uH - 1 - row) : row) * uW;
+        Uint8 *d       = &m_layer[(uY + row) * m_uLayerW + uX];
+
+        for (unsigned int col = 0; col < uW; col++) {
+            Uint8 p = s[(uFlags & TILE_XFLIP) ? (uW - 1 - col) : col];
+            if (p) d[col] = p + u8Color;
+        }
+    }
+}
+
+void tilemap::update()
+{
+    if (!m_bDirty) return;
+
+    unsigned int uW = m_pTiles->get_width();
+    unsigned int uH = m_pTiles->get_height();
+
+    for (unsigned int row = 0; row < m_uRows; row++) {
+        unsigned int uFirst = row * m_uCols;
+        unsigned int uY     = m_iOriginY + row * m_uPitchY;
+        bool bChanged       = false;
+
+        if (m_bOverlap) {
+            // a cell's neighbours draw over its edges, so the whole row gets
+            // redrawn, left to right
+            for (unsigned int col = 0; col < m_uCols; col++) {
+                if (m_dirty[uFirst + col]) bChanged = true;
+            }
+            if (!bChanged) continue;
+
+            memset(&m_layer[uY * m_uLayerW], 0, uH * m_uLayerW);
+            for (unsigned int col = 0; col < m_uCols; col++) {
+                draw_cell(uFirst + col);
+            }
+        } else {
+            for (unsigned int col = 0; col < m_uCols; col++) {
+                unsigned int uCell = uFirst + col;
+                if (!m_dirty[uCell]) continue;
+
+                unsigned int uX = m_iOriginX + col * m_uPitchX;
+                for (unsigned int y = 0; y < uH; y++) {
+                    memset(&m_layer[(uY + y) * m_uLayerW + uX], 0, uW);
+                }
+                draw_cell(uCell);
+                bChanged = true;
+            }
+            if (!bChanged) continue;
+        }
+
+        m_row_empty[row] = 1;
+        for (unsigned int col = 0; col < m_uCols; col++) {
+            if (!(m_state[uFirst + col] & CELL_EMPTY)) {
+                m_row_empty[row] = 0;
+                break;
+            }
+        }
+    }
+
+    m_bDirty = false;
+}
+
+// copies the visible pixels of a rectangle of the layer to the same place on
+// 'dst'
+void tilemap::copy(SDL_Surface *dst, unsigned int uX, unsigned int uY, unsigned int uW,
+                   unsigned int uH, bool bOpaque, const Uint8 *lut) const
+{
+    if ((int)uX >= dst->w || (int)uY >= dst->h) return;
+    if (uX + uW > (unsigned int)dst->w) uW = dst->w - uX;
+    if (uY + uH > (unsigned int)dst->h) uH = dst->h - uY;
+
+    for (unsigned int row = 0; row < uH; row++) {
+        const Uint8 *s = &m_layer[(uY + row) * m_uLayerW + uX];
+        Uint8 *d       = (Uint8 *)dst->pixels + (uY + row) * dst->pitch + uX;
+
+        if (bOpaque && !lut) {
+            memcpy(d, s, uW);
+        } else if (lut) {
+            for (unsigned int col = 0; col < uW; col++) {
+                if (s[col]) d[col] = lut[s[col]];
+            }
+        } else {
+            for (unsigned int col = 0; col < uW; col++) {
+                if (s[col]) d[col] = s[col];
+            }
+        }
+    }
+}
+
+void tilemap::draw(SDL_Surface *dst, const Uint8 *lut)
+{
+    if (!m_pTiles) return;
+
+    update();
+
+    unsigned int uW = m_pTiles->get_width();
+    unsigned int uH = m_pTiles->get_height();
+
+    for (unsigned int row = 0; row < m_uRows; row++) {
+        if (m_row_empty[row]) continue;
+
+        unsigned int uY = m_iOriginY + row * m_uPitchY;
+
+        if (m_bOverlap) {
+            copy(dst, m_iOriginX, uY, m_uLayerW - m_iOriginX, uH, false, lut);
+            continue;
+        }
+
+        for (unsigned int col = 0; col < m_uCols; col++) {
+            Uint8 u8State = m_state[row * m_uCols + col];
+            if (u8State & CELL_EMPTY) continue;
+
+            copy(dst, m_iOriginX + col * m_uPitchX, uY, uW, uH,
+                 (u8State & CELL_OPAQUE) != 0, lut);
+        }
+    }
+}
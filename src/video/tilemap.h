@@ -0,0 +1,140 @@
+/*
+ * ____ DAPHNE COPYRIGHT NOTICE ____
+ *
+ * This file is part of DAPHNE, a laserdisc arcade game emulator
+ *
+ * DAPHNE is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * DAPHNE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// tilemap.h
+// Character and sprite rendering shared by the boards that draw their own
+// 8-bit overlay (astron, gpworld, mach3, interstellar, cobraconv).
+// The driver decodes its graphics ROMs into a tileset once, after load_roms(),
+// and then every repaint() only has to copy bytes around.
+
+#ifndef TILEMAP_H
+#define TILEMAP_H
+
+#include <SDL.h>
+#include <vector>
+
+enum { TILE_XFLIP = 1, TILE_YFLIP = 2 };
+
+// A set of equally sized graphics (characters or sprites), one byte per pixel.
+// Pixel value 0 is transparent.
+class tileset
+{
+  public:
+    tileset();
+
+    // allocates 'uCount' blank tiles of uWidth x uHeight pixels
+    bool create(unsigned int uCount, unsigned int uWidth, unsigned int uHeight);
+
+    // pixels of tile 'n', row by row, for the driver to fill in
+    Uint8 *get_tile(unsigned int n) { return &m_pixels[n * m_uWidth * m_uHeight]; }
+    const Uint8 *get_tile(unsigned int n) const
+    {
+        return &m_pixels[n * m_uWidth * m_uHeight];
+    }
+
+    // must be called once the driver has filled in all the tiles
+    void finalize();
+
+    // Draws tile 'n' onto the 8-bit surface 'dst' with its top left corner at
+    // x,y, clipped to the surface.  Each visible pixel is written as
+    // pixel + u8Color.
+    void draw(SDL_Surface *dst, unsigned int n, int x, int y, unsigned int uFlags,
+              Uint8 u8Color = 0) const;
+
+    unsigned int get_count() const { return m_uCount; }
+    unsigned int get_width() const { return m_uWidth; }
+    unsigned int get_height() const { return m_uHeight; }
+    bool is_empty(unsigned int n) const { return (m_flags[n] & FLAG_EMPTY) != 0; }
+    bool is_opaque(unsigned int n) const { return (m_flags[n] & FLAG_OPAQUE) != 0; }
+
+  private:
+    enum { FLAG_EMPTY = 1, FLAG_OPAQUE = 2 };
+
+    unsigned int m_uCount, m_uWidth, m_uHeight;
+    std::vector<Uint8> m_pixels;
+    std::vector<Uint8> m_flags;
+};
+
+// A grid of cells from one tileset, as laid out in a board's video RAM.
+// The driver hands over every cell with set() each repaint; only the cells
+// whose tile, color or flips changed since the last repaint get redrawn into
+// the map's own buffer, which draw() then lays over the overlay.
+class tilemap
+{
+  public:
+    tilemap();
+
+    // uCols x uRows cells, cell (col, row) having its top left corner at
+    // (iOriginX + col * uPitchX, iOriginY + row * uPitchY) on the overlay.
+    // uPitchX may be less than the tile width, in which case columns overlap
+    // and the ones to the right win (gpworld).
+    bool create(const tileset *pTiles, unsigned int uCols, unsigned int uRows,
+                unsigned int uPitchX, unsigned int uPitchY, int iOriginX = 0,
+                int iOriginY = 0);
+
+    // Cells start out empty.  Visible pixels of the cell are written as
+    // pixel + u8Color.
+    void set(unsigned int uCol, unsigned int uRow, unsigned int uTile,
+             Uint8 u8Color = 0, unsigned int uFlags = 0)
+    {
+        unsigned int uCell = uRow * m_uCols + uCol;
+        Uint32 uKey        = uTile | (u8Color << 16) | (uFlags << 24);
+        if (m_cells[uCell] != uKey) {
+            m_cells[uCell] = uKey;
+            m_dirty[uCell] = 1;
+            m_bDirty       = true;
+        }
+    }
+
+    // forces every cell to be redrawn
+    void invalidate();
+
+    // Brings the dirty cells up to date, then copies the visible pixels to
+    // the 8-bit surface 'dst'.  If 'lut' is not NULL, pixels go through it on
+    // the way (for drivers that remap their colors after the fact).
+    void draw(SDL_Surface *dst, const Uint8 *lut = NULL);
+
+  private:
+    enum { CELL_EMPTY = 1, CELL_OPAQUE = 2 };
+    static const Uint32 NO_TILE = 0xFFFFFFFF;
+
+    void update();
+    void draw_cell(unsigned int uCell);
+    void copy(SDL_Surface *dst, unsigned int uX, unsigned int uY, unsigned int uW,
+              unsigned int uH, bool bOpaque, const Uint8 *lut) const;
+
+    const tileset *m_pTiles;
+    unsigned int m_uCols, m_uRows, m_uPitchX, m_uPitchY;
+    int m_iOriginX, m_iOriginY;
+    bool m_bOverlap;
+    bool m_bDirty;
+
+    // what each cell holds (tile | color << 16 | flags << 24)
+    std::vector<Uint32> m_cells;
+    std::vector<Uint8> m_dirty;
+    std::vector<Uint8> m_state; // CELL_*
+    std::vector<Uint8> m_row_empty;
+
+    // the cells drawn out, in overlay coordinates
+    std::vector<Uint8> m_layer;
+    unsigned int m_uLayerW, m_uLayerH;
+};
+
+#endif
@@ -68,6 +68,68 @@ int g_transparency_latch   = 0;
 int introHack     = 0;
 int prevg_vidmode = 0;
 void tms9128nl_clear_overlay();
+
+// Each 8 bytes of pattern memory, expanded to one mask byte per pixel (0xFF
+// where the pixel is set) the first time a character uses it.  Writes to
+// video memory throw out the block they land in.
+static const unsigned int TMS_GLYPH_COUNT = 0x4000 / 8;
+static Uint8 g_glyphs[TMS_GLYPH_COUNT][64];
+static bool g_glyph_valid[TMS_GLYPH_COUNT] = {false};
+
+// Which 8x8 cells of g_vidbuf have changed, and when.  Every repaint starts a
+// new epoch; the overlay surfaces (the game double-buffers them) remember the
+// epoch they were painted in, so each one only gets the cells that changed
+// since then.
+static const int TMS_CELLS_W = TMS9128NL_OVERLAY_W / 8;
+static const int TMS_CELLS_H = TMS9128NL_OVERLAY_H / 8;
+static Uint32 g_cell_epoch[TMS_CELLS_W * TMS_CELLS_H];
+static Uint32 g_epoch = 1;
+
+struct painted_s {
+    SDL_Surface *surface;
+    Uint32 uEpoch;  // first epoch whose changes it doesn't have yet
+    bool bStretched;
+};
+static painted_s g_painted[4];
+static unsigned int g_uNextPainted = 0;
+
+// flags the cells covering the given part of g_vidbuf as changed
+static void tms9128nl_mark_dirty(int x, int y, int w, int h)
+{
+    if (x < 0) { w += x; x = 0; }
+    if (x + w > TMS9128NL_OVERLAY_W) w = TMS9128NL_OVERLAY_W - x;
+    if (y + h > TMS9128NL_OVERLAY_H) h = TMS9128NL_OVERLAY_H - y;
+    if (w <= 0 || h <= 0) return;
+
+    for (int row = y >> 3; row <= (y + h - 1) >> 3; row++) {
+        for (int col = x >> 3; col <= (x + w - 1) >> 3; col++) {
+            g_cell_epoch[row * TMS_CELLS_W + col] = g_epoch;
+        }
+    }
+}
+
+static void tms9128nl_mark_all_dirty()
+{
+    tms9128nl_mark_dirty(0, 0, TMS9128NL_OVERLAY_W, TMS9128NL_OVERLAY_H);
+}
+
+// returns the pixel masks for the 8 bytes of pattern memory at 'bmp_index'
+static const Uint8 *tms9128nl_get_glyph(int bmp_index)
+{
+    unsigned int n = (bmp_index >> 3) & (TMS_GLYPH_COUNT - 1);
+
+    if (!g_glyph_valid[n]) {
+        for (int i = 0; i < 8; i++) {
+            unsigned char line = vidmem[(n << 3) + i];
+            for (int j = 0; j < 8; j++) {
+                g_glyphs[n][(i << 3) + j] = (line & (0x80 >> j)) ? 0xFF : 0x00;
+            }
+        }
+        g_glyph_valid[n] = true;
+    }
+
+    return g_glyphs[n];
+}
 ////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////
 
@@ -96,6 +158,9 @@ void tms9128nl_reset()
     g_transparency_latch    = 0;
     introHack               = 0;
     prevg_vidmode           = 0;
+    memset(g_glyph_valid, 0, sizeof(g_glyph_valid));
+    memset(g_painted, 0, sizeof(g_painted));
+    tms9128nl_mark_all_dirty();
 }
 
 bool tms9128nl_int_enabled() { return (g_tms_interrupt_enabled); }
@@ -470,6 +535,7 @@ void tms9128nl_write_port0(unsigned char Value)
 // return a 1 if the screen needs updating
 {
     vidmem[wvidindex] = Value;
+    if (wvidindex < 0x4000) g_glyph_valid[wvidindex >> 3] = false;
     wvidindex++;                // the index always advances when we write
     tms9128nl_writechar(Value); // update the screen
 }
@@ -588,7 +654,6 @@ void tms9128nl_drawchar(unsigned char ch, int col, int row)
     int i = 0, j = 0;                                  // temp indices
     int x                          = col * CHAR_WIDTH;
     int y                          = row * CHAR_HEIGHT;
-    unsigned char line             = 0;
     unsigned char background_color = TMS_BG_COLOR;
 
     // if character is 0 and we're in transparency mode, make bitmap transparent
@@ -648,24 +713,17 @@ void tms9128nl_drawchar(unsigned char ch, int col, int row)
     }
 
     // draw each line of character into new surface
+    const Uint8 *glyph = tms9128nl_get_glyph(bmp_index);
     for (i = 0; i < CHAR_HEIGHT; i++) {
-        line = vidmem[bmp_index + i]; // get a line
-
-        // handle each pixel across
-        for (j = CHAR_WIDTH - 1; j >= 0; j--) {
-            // if rightmost bit is 1, it means draw the pixel
-            if (line & 1) {
-                *((Uint8 *)g_vidbuf + ((y + i + TMS_VERTICAL_OFFSET) * TMS9128NL_OVERLAY_W) +
-                  (x + j)) = TMS_FG_COLOR;
-            }
-            // else draw the background
-            else {
-                *((Uint8 *)g_vidbuf + ((y + i + TMS_VERTICAL_OFFSET) * TMS9128NL_OVERLAY_W) +
-                  (x + j)) = background_color;
-            }
-            line = (unsigned char)(line >> 1);
+        Uint8 *dst = (Uint8 *)g_vidbuf + ((y + i + TMS_VERTICAL_OFFSET) * TMS9128NL_OVERLAY_W) + x;
+
+        // set pixels get the foreground color, the rest the background
+        for (j = 0; j < CHAR_WIDTH; j++) {
+            Uint8 mask = glyph[(i << 3) + j];
+            dst[j]     = (Uint8)((mask & TMS_FG_COLOR) | (~mask & background_color));
         }
     } // end for loop
+    tms9128nl_mark_dirty(x, y + TMS_VERTICAL_OFFSET, CHAR_WIDTH, CHAR_HEIGHT);
 
     // In transparency mode, if we draw a solid character, we need to make the
     // character after it non-transparent
@@ -685,11 +743,23 @@ void tms9128nl_drawchar(unsigned char ch, int col, int row)
             }
             ptr += (TMS9128NL_OVERLAY_W - CHAR_WIDTH); // move to the next line
         }
+        tms9128nl_mark_dirty(x + CHAR_WIDTH, y + TMS_VERTICAL_OFFSET, CHAR_WIDTH, CHAR_HEIGHT);
     }
 
     g_game->set_video_overlay_needs_update(true);
 }
 
+struct outcommand_s {
+    SDL_Rect dest;
+    char *s;
+};
+
+static void tms9128nl_outcommand_job(void *param)
+{
+    outcommand_s *cmd = (outcommand_s *)param;
+    FC_Draw(video::get_font(), video::get_renderer(), cmd->dest.x, cmd->dest.y, cmd->s);
+}
+
 void tms9128nl_outcommand(char *s, int col, int row)
 {
     // gp2x doesn't have enough resolution to display this schlop anyway...
@@ -705,7 +775,8 @@ void tms9128nl_outcommand(char *s, int col, int row)
     // VLDP freaks out if it's not the only thing drawing to the screen
     if (!g_ldp->is_vldp()) {
         // vid_blank();
-        FC_Draw(video::get_font(), video::get_renderer(), dest.x, dest.y, s);
+        outcommand_s cmd = {dest, s};
+        video::vid_run(tms9128nl_outcommand_job, &cmd);
         // TODO : get this working again under the new video scheme
     }
 }
@@ -792,30 +863,75 @@ void tms9128nl_video_repaint()
         }
 
         g_transparency_latch = g_transparency_enabled;
+        tms9128nl_mark_all_dirty();
     }
 
     g_transparency_enabled = 0; // apparently this has to be set to true every
                                 // pulse of the NMI in order
     // to maintain the transparency.  The Cliff ROM does this.
 
+    SDL_Surface *overlay = g_game->get_active_video_overlay();
+    bool bStretched      = (g_vidmode == 2);
+    painted_s *painted   = NULL;
+
+    for (unsigned int u = 0; u < sizeof(g_painted) / sizeof(g_painted[0]); u++) {
+        if (g_painted[u].surface == overlay) painted = &g_painted[u];
+    }
+
+    // a surface we haven't painted before, or painted the other way, gets
+    // everything
+    if (!painted || (painted->bStretched != bStretched)) {
+        if (!painted) {
+            painted = &g_painted[g_uNextPainted];
+            g_uNextPainted = (g_uNextPainted + 1) % (sizeof(g_painted) / sizeof(g_painted[0]));
+        }
+        painted->surface    = overlay;
+        painted->bStretched = bStretched;
+        painted->uEpoch     = 0;
+    }
+
     // if we're in video mode 2, we have to display our stretched overlay
     // instead of our regular one
-    if (g_vidmode == 2) {
-        tms9128nl_video_repaint_stretched();
+    if (bStretched) {
+        tms9128nl_video_repaint_stretched(painted->uEpoch);
     }
 
     // if we're not in mode 2, display our non-stretched overlay
     else {
-        memcpy(g_game->get_active_video_overlay()->pixels, g_vidbuf,
-               TMS9128NL_OVERLAY_W * TMS9128NL_OVERLAY_H);
+        Uint8 *dst = (Uint8 *)overlay->pixels;
+
+        for (int row = 0; row < TMS_CELLS_H; row++) {
+            const Uint32 *epochs = &g_cell_epoch[row * TMS_CELLS_W];
+            int col              = 0;
+
+            // copy each run of changed cells on this row
+            while (col < TMS_CELLS_W) {
+                if (epochs[col] < painted->uEpoch) {
+                    col++;
+                    continue;
+                }
+
+                int first = col;
+                while ((col < TMS_CELLS_W) && (epochs[col] >= painted->uEpoch)) col++;
+
+                for (int y = row << 3; y < (row << 3) + 8; y++) {
+                    memcpy(dst + y * TMS9128NL_OVERLAY_W + (first << 3),
+                           g_vidbuf + y * TMS9128NL_OVERLAY_W + (first << 3), (col - first) << 3);
+                }
+            }
+        }
     }
+
+    painted->uEpoch = g_epoch + 1;
+    g_epoch++;
 }
 
 // creates the stretched overlay, using the contents of the normal overlay as
 // its source
 // the stretched overlay is simply a 256x192 window scaled to 320x192 using a
 // hard-coded algorithm (hopefully it's fast)
-void tms9128nl_video_repaint_stretched()
+// Only rows of cells with changes from epoch 'uEpoch' onwards are redone.
+void tms9128nl_video_repaint_stretched(Uint32 uEpoch)
 {
     int x256 = 0;
     int y    = 0;
@@ -823,6 +939,7 @@ void tms9128nl_video_repaint_stretched()
     Uint8 *ptr256 = (Uint8 *)g_vidbuf; // source ...
     Uint8 *ptr320 = (Uint8 *)g_game->get_active_video_overlay()->pixels; // destination
                                                                          // ...
+    bool bRowChanged = false;
 
     // these values correspond to colors in the color palette
     unsigned char blend[4][2] = {
@@ -831,6 +948,24 @@ void tms9128nl_video_repaint_stretched()
 
     // do every row
     for (y = 0; y < TMS9128NL_OVERLAY_H; y++) {
+        // the stretch smears pixels across cell boundaries, so a whole row of
+        // cells is redone if any of them changed
+        if ((y & 7) == 0) {
+            const Uint32 *epochs = &g_cell_epoch[(y >> 3) * TMS_CELLS_W];
+            bRowChanged          = false;
+            for (int col = 0; col < TMS_CELLS_W; col++) {
+                if (epochs[col] >= uEpoch) {
+                    bRowChanged = true;
+                    break;
+                }
+            }
+        }
+        if (!bRowChanged) {
+            ptr256 += 320;
+            ptr320 += 320;
+            continue;
+        }
+
         // do each pixel, but divide it up into smallest integer sections so we
         // can use a hard-coded algorithm
         // there is a 4:5 correspondance between the 256 and 320 surfaces
@@ -898,6 +1033,7 @@ void tms9128nl_clear_overlay()
         *ptr = clear_color;
         ptr++;
     }
+    tms9128nl_mark_all_dirty();
 
     // bottom area always gets border color and is never transparent
     for (i = 0; i < TMS9128NL_OVERLAY_W * TMS_VERTICAL_OFFSET; i++) {
@@ -64,7 +64,7 @@ void tms9128nl_outcommand(char *s, int col, int row);
 void tms9128nl_palette_update();
 void tms9128nl_palette_calculate();
 void tms9128nl_video_repaint();
-void tms9128nl_video_repaint_stretched();
+void tms9128nl_video_repaint_stretched(Uint32 uEpoch);
 void tms9128nl_set_transparency();
 
 #endif
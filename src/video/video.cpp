@@ -32,8 +32,12 @@
 #include "../io/mpo_fileio.h"
 #include "../io/mpo_mem.h"
 #include "../ldp-out/ldp.h"
+#include "capture.h"
 #include "palette.h"
+#include "spritebatch.h"
+#include "textcache.h"
 #include "video.h"
+#include "yuvblend.h"
 #include <SDL_syswm.h> // rdg2010
 #include <SDL_image.h> // screenshot
 #include <plog/Log.h>
@@ -42,11 +46,9 @@
 #include <string.h>
 #include <string> // for some error messages
 
-// MAC: sdl_video_run thread defines block
-#define SDL_VIDEO_RUN_UPDATE_YUV_TEXTURE	1
-#define SDL_VIDEO_RUN_CREATE_YUV_TEXTURE	2
-#define SDL_VIDEO_RUN_DESTROY_TEXTURE		3
-#define SDL_VIDEO_RUN_END_THREAD		4
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
 
 using namespace std;
 
@@ -96,6 +98,11 @@ bool g_singe_blend_sprite = false;
 
 bool g_scanlines = false;
 
+// the scanline pattern, one pixel wide and as tall as the draw area, which
+// gets stretched across the screen (see draw_scanlines)
+SDL_Texture *g_scanline_texture = NULL;
+unsigned int g_scanline_height  = 0;
+
 bool g_fakefullscreen = false;
 
 bool g_vid_resized = false;
@@ -130,30 +137,51 @@ char *LDP1450_200;
 // the # of degrees to rotate counter-clockwise in opengl mode
 float g_fRotateDegrees = 0.0;
 
-// SDL sdl_video_run thread variables
-SDL_Thread *sdl_video_run_thread;
-bool sdl_video_run_loop = true;
-int sdl_video_run_action = 0;
-int sdl_video_run_result = 0;
-
-// SDL sdl_video_run thread function prototypes
-void sdl_video_run_rendercopy (SDL_Renderer *renderer, SDL_Texture *texture, SDL_Rect *src, SDL_Rect* dst);
-
-// SDL Texture creation, update and destruction parameters
-int yuv_texture_width;
-int yuv_texture_height;
-SDL_Renderer *sdl_renderer;
-SDL_Texture *yuv_texture;
-//SDL_Texture *sdl_texture;
-void *sdl_run_param;
-
-// SDL YUV texture update parameters
-uint8_t *yuv_texture_Yplane;
-uint8_t *yuv_texture_Uplane;
-uint8_t *yuv_texture_Vplane;
-int yuv_texture_Ypitch;
-int yuv_texture_Upitch;
-int yuv_texture_Vpitch;
+// SDL sdl_video_run thread variables (-render_thread)
+// The thread does the composition and SDL_RenderPresent() so that a vsync
+// stall doesn't hold up the emulation.  vid_blit() leaves the new overlay and
+// LEDs in a mailbox for it, and anything else that needs the renderer goes
+// through vid_run() so that only one thread ever touches it.
+bool g_render_thread = false; // whether the user asked for it
+SDL_Thread *sdl_video_run_thread = NULL;
+SDL_threadID sdl_video_run_id;
+bool sdl_video_run_loop = false;
+SDL_mutex *sdl_video_run_mutex = NULL;
+SDL_cond *sdl_video_run_cond = NULL;      // something for the thread to do
+SDL_cond *sdl_video_run_done_cond = NULL; // a vid_run() job has finished
+
+// vid_run() job slot
+void (*sdl_video_run_job)(void *) = NULL;
+void *sdl_video_run_param;
+Uint32 sdl_video_run_job_seq = 0, sdl_video_run_done_seq = 0;
+
+// the mailbox: copies of the overlay and LED surfaces as of the last vid_blit()
+bool g_mailbox_frame_pending = false;
+SDL_Surface *g_mailbox_overlay = NULL;
+SDL_Rect g_mailbox_overlay_rect = {0, 0, 0, 0}; // what needs uploading
+SDL_Surface *g_mailbox_leds = NULL;
+bool g_mailbox_leds_pending = false;
+Uint64 g_mailbox_posted = 0; // when the pending frame was handed over
+
+render_stats_s g_render_stats = {0, 0, 0.0, 0.0};
+double g_render_latency_total = 0.0;
+
+static void vid_start_render_thread();
+static void vid_stop_render_thread();
+static void capture_frame();
+
+// The subtitle and LDP1450 text are set by the emulation and drawn by
+// vid_present(), so with -render_thread both sides hold the mailbox mutex
+// while they touch it.  (SDL mutexes are recursive.)
+static void vid_lock_text()
+{
+    if (sdl_video_run_thread) SDL_LockMutex(sdl_video_run_mutex);
+}
+
+static void vid_unlock_text()
+{
+    if (sdl_video_run_thread) SDL_UnlockMutex(sdl_video_run_mutex);
+}
 
 // SDL video and texture readyness variables
 bool g_bIsSDLDisplayReady = false;
@@ -166,6 +194,9 @@ typedef struct {
     int Ysize, Usize, Vsize; // The size of each plane in bytes.
     int Ypitch, Upitch, Vpitch; // The pitch of each plane in bytes.
     SDL_mutex *mutex;
+    // Bumped before and after the planes are written, so it's odd while they
+    // are being changed: vid_read_yuv_pixels() uses it instead of the mutex.
+    SDL_atomic_t seq;
 } g_yuv_surface_t;
 
 g_yuv_surface_t *g_yuv_surface;
@@ -177,6 +208,43 @@ bool g_yuv_video_needs_update  = false;
 bool g_yuv_video_needs_blank   = false;
 bool g_ldp1450_old_overlay     = false;
 
+// 8bpp overlay -> RGBA8888 conversion.
+// The palette is packed into a lookup table that is only rebuilt when SDL
+// tells us the palette has changed, and the last converted frame is kept
+// (as palette indexes) so that only the rows/columns that actually changed get
+// converted and uploaded to the overlay texture.
+Uint32 g_overlay_lut[256];
+SDL_Palette *g_overlay_lut_palette = NULL;
+Uint32 g_overlay_lut_version       = 0;
+Uint8 *g_overlay_shadow            = NULL; // last converted frame
+int g_overlay_shadow_w = 0, g_overlay_shadow_h = 0;
+bool g_overlay_shadow_valid = false;
+int g_overlay_last_bpp      = 0; // whether the last overlay was 8 or 32-bit
+SDL_Rect g_overlay_dirty_rect = {0, 0, 0, 0}; // (relative to the overlay)
+
+// -yuv_compose: the 8-bit overlay is drawn straight into a copy of the video's
+// YUV planes (see yuvblend.h) and the YUV texture is all that gets rendered.
+// It needs disc video and the overlay texture to be otherwise unused, so it
+// steps aside for noldp mode and for the LED overlays.
+bool g_yuv_compose     = false; // whether the user asked for it
+bool g_compose_active  = false; // whether the current frame gets composed
+bool g_compose_blocked = false; // the LEDs are using the overlay texture
+bool g_compose_dirty   = false; // the overlay has changed since it was composed
+Uint8 *g_compose_buf   = NULL;  // the composed Y, U and V planes
+int g_compose_size     = 0;
+
+// -headless: SDL's offscreen (or dummy) video driver and the software
+// renderer, so the frame is built exactly as usual but no display is needed.
+// -frame_hash writes a hash of every presented frame to a file so that runs
+// can be compared.
+bool g_headless          = false;
+string g_frame_hash_path = "";
+FILE *g_frame_hash_file  = NULL;
+Uint8 *g_frame_hash_buf  = NULL; // the frame read back from the renderer
+int g_frame_hash_size    = 0;
+Uint64 g_frame_hash_all  = 0; // hash of all the frames, in order
+Uint64 g_headless_start  = 0;
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 // initializes the window in which we will draw our BMP's
@@ -189,12 +257,38 @@ bool init_display()
     bool fs = false;
     char title[50] = "HYPSEUS Singe: Multiple Arcade Laserdisc Emulator";
 
+    // We get called again whenever a game re-inits its video (Singe resizing
+    // and so on).  The window and renderer are rebuilt below, so the render
+    // thread has to be done with them first; it is started again at the end.
+    vid_stop_render_thread();
 
     sdl_flags = SDL_WINDOW_SHOWN;
     sdl_sb_flags = SDL_WINDOW_ALWAYS_ON_TOP;
 
+    int iInit = -1;
+    if (g_headless) {
+        // offscreen is only in newer SDLs, dummy has been there forever
+        SDL_SetHint(SDL_HINT_VIDEODRIVER, "offscreen");
+        iInit = SDL_InitSubSystem(SDL_INIT_VIDEO);
+        if (iInit < 0) {
+            SDL_SetHint(SDL_HINT_VIDEODRIVER, "dummy");
+            iInit = SDL_InitSubSystem(SDL_INIT_VIDEO);
+        }
+        if (iInit >= 0) {
+            LOGI << fmt("Running headless, using the '%s' video driver",
+                        SDL_GetCurrentVideoDriver());
+            sdl_flags    = SDL_WINDOW_HIDDEN;
+            sdl_sb_flags = SDL_WINDOW_HIDDEN;
+            g_fullscreen = g_fakefullscreen = false;
+            g_game->m_sdl_software_rendering = true;
+            g_headless_start = SDL_GetPerformanceCounter();
+        }
+    } else {
+        iInit = SDL_InitSubSystem(SDL_INIT_VIDEO);
+    }
+
     // if we were able to initialize the video properly
-    if (SDL_InitSubSystem(SDL_INIT_VIDEO) >= 0) {
+    if (iInit >= 0) {
 
         if (g_fullscreen) { sdl_flags |= SDL_WINDOW_FULLSCREEN_DESKTOP; fs = true; }
         else if (g_fakefullscreen) sdl_flags |= SDL_WINDOW_MAXIMIZED | SDL_WINDOW_BORDERLESS;
@@ -376,12 +470,26 @@ bool init_display()
 
 		    SDL_SetTextureBlendMode(g_overlay_texture, SDL_BLENDMODE_BLEND);
 		    SDL_SetTextureAlphaMod(g_overlay_texture, 255);
+
+		    // the new texture is empty, so the whole overlay must be uploaded
+		    g_overlay_shadow_valid = false;
                 }
 
                 SDL_SetRenderDrawColor(g_renderer, 0, 0, 0, 255);
                 SDL_RenderClear(g_renderer);
                 SDL_RenderPresent(g_renderer);
                 // NOTE: SDL Console was initialized here.
+
+                if (!g_frame_hash_path.empty() && !g_frame_hash_file) {
+                    g_frame_hash_file = fopen(g_frame_hash_path.c_str(), "w");
+                    if (!g_frame_hash_file)
+                        LOGW << fmt("Could not open '%s' for the frame hashes",
+                                    g_frame_hash_path.c_str());
+                }
+
+                // from here on, only the render thread may use the renderer
+                if (g_render_thread) vid_start_render_thread();
+
                 result = true;
             }
         }
@@ -396,7 +504,7 @@ bool init_display()
     return (result);
 }
 
-void vid_free_yuv_overlay () {
+static void vid_free_yuv_overlay_job(void *) {
     // Here we free both the YUV surface and YUV texture.
     SDL_DestroyMutex (g_yuv_surface->mutex);
    
@@ -404,21 +512,67 @@ void vid_free_yuv_overlay () {
     free(g_yuv_surface->Uplane);
     free(g_yuv_surface->Vplane);
     free(g_yuv_surface);
+    g_yuv_surface = NULL;
 
     SDL_DestroyTexture(g_yuv_texture);
+    g_yuv_texture = NULL;
+
+    // the overlay has to go back to its own texture
+    if (g_compose_active) {
+        g_compose_active       = false;
+        g_overlay_shadow_valid = false;
+    }
 }
 
+// (on the render thread, so it can't be halfway through using them)
+void vid_free_yuv_overlay () { vid_run(vid_free_yuv_overlay_job, NULL); }
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 // deinitializes the window and renderer we have used.
 // returns true if successful, false if failure
 bool deinit_display()
 {
+    vid_stop_render_thread();
+    capture::shutdown();
+
+    if (g_headless) {
+        double dSecs = (double)(SDL_GetPerformanceCounter() - g_headless_start) /
+                       SDL_GetPerformanceFrequency();
+        LOGI << fmt("Headless: %u frames in %.1f seconds (%.1f fps)",
+                    g_render_stats.uFrames, dSecs,
+                    (dSecs > 0) ? g_render_stats.uFrames / dSecs : 0.0);
+    }
+
+    if (g_frame_hash_file) {
+        fprintf(g_frame_hash_file, "all %016llx\n", (unsigned long long)g_frame_hash_all);
+        fclose(g_frame_hash_file);
+        g_frame_hash_file = NULL;
+        LOGI << fmt("Frame hash of the whole run: %016llx",
+                    (unsigned long long)g_frame_hash_all);
+    }
+    free(g_frame_hash_buf);
+    g_frame_hash_buf  = NULL;
+    g_frame_hash_size = 0;
+
     SDL_FreeSurface(g_screen_blitter);
     SDL_FreeSurface(g_leds_surface);
 
+    spritebatch::shutdown();
+
     SDL_DestroyTexture(g_overlay_texture);
     SDL_DestroyTexture(g_sb_texture);
+    SDL_DestroyTexture(g_scanline_texture);
+    g_scanline_texture = NULL;
+
+    delete[] g_overlay_shadow;
+    g_overlay_shadow       = NULL;
+    g_overlay_shadow_valid = false;
+
+    delete[] g_compose_buf;
+    g_compose_buf    = NULL;
+    g_compose_size   = 0;
+    g_compose_active = false;
 
     SDL_DestroyRenderer(g_sb_renderer);
     SDL_DestroyRenderer(g_renderer);
@@ -431,6 +585,7 @@ void shutdown_display()
 {
     LOGD << "Shutting down video display...";
 
+    textcache::clear();
     TTF_Quit();
     FC_FreeFont(g_font);
     FC_FreeFont(g_fixfont);
@@ -438,12 +593,14 @@ void shutdown_display()
 }
 
 // Clear the renderer. Good for avoiding texture mess (YUV, LEDs, Overlay...)
-void vid_blank()
+static void vid_blank_job(void *)
 {
     SDL_SetRenderDrawColor(g_renderer, 0, 0, 0, 255);
     SDL_RenderClear(g_renderer);
 }
 
+void vid_blank() { vid_run(vid_blank_job, NULL); }
+
 // redraws the proper display (Scoreboard, etc) on the screen, after first
 // clearing the screen
 // call this every time you want the display to return to normal
@@ -594,8 +751,10 @@ void draw_charline_LDP1450(char *LDP1450_String, int start_x, int y, SDL_Surface
     for (i = 0; i < LDP1450_strlen; p++, i++)
        if (*p == 32) j++;
 
+    vid_lock_text();
     if (j == 12) draw_LDP1450_overlay(LDP1450_String, 0, 0, 0, 1);
     else draw_LDP1450_overlay(LDP1450_String, start_x, y, 1, 0);
+    vid_unlock_text();
 }
 
 void draw_singleline_LDP1450(char *LDP1450_String, int start_x, int y, SDL_Surface *overlay)
@@ -732,6 +891,29 @@ void set_fakefullscreen(bool value) { g_fakefullscreen = value; }
 
 void set_scanlines(bool value) { g_scanlines = value; }
 
+void set_render_thread(bool bEnabled) { g_render_thread = bEnabled; }
+
+void set_yuv_compose(bool bEnabled) { g_yuv_compose = bEnabled; }
+
+void set_headless(bool bEnabled) { g_headless = bEnabled; }
+
+void set_frame_hash_file(const char *szPath) { g_frame_hash_path = szPath; }
+
+int get_refresh_rate()
+{
+    SDL_DisplayMode mode;
+    if (!g_window || (SDL_GetWindowDisplayMode(g_window, &mode) < 0)) return 0;
+    return mode.refresh_rate;
+}
+
+bool get_blit_waits_vsync()
+{
+    SDL_RendererInfo info;
+    if (!g_renderer || sdl_video_run_thread || g_headless) return false;
+    if (SDL_GetRendererInfo(g_renderer, &info) < 0) return false;
+    return (info.flags & SDL_RENDERER_PRESENTVSYNC) != 0;
+}
+
 void set_queue_screenshot(bool value) { queue_take_screenshot = value; }
 
 void set_fullscreen_scale_nearest(bool value) { g_fs_scale_nearest = value; }
@@ -806,10 +988,10 @@ void draw_string(const char *t, int col, int row, SDL_Surface *surface)
 
     SDL_FillRect(surface, &dest, 0x00000000);
     SDL_Color color={225, 225, 225};
-    text_surface=TTF_RenderText_Solid(g_tfont, t, color);
+    SDL_Color black={0, 0, 0};
+    text_surface=textcache::get(g_tfont, textcache::QUALITY_SOLID, color, black, t);
 
-    SDL_BlitSurface(text_surface, NULL, surface, &dest);
-    SDL_FreeSurface(text_surface);
+    if (text_surface) SDL_BlitSurface(text_surface, NULL, surface, &dest);
 }
 
 void draw_subtitle(char *s, SDL_Surface *surface, bool insert)
@@ -820,6 +1002,8 @@ void draw_subtitle(char *s, SDL_Surface *surface, bool insert)
     static int count;
     int delay = 100;
 
+    vid_lock_text();
+
     if (insert) {
        count = 0;
        set_subtitle_enabled(true);
@@ -834,6 +1018,8 @@ void draw_subtitle(char *s, SDL_Surface *surface, bool insert)
        FC_Draw(get_font(), renderer, x, y, s);
 
     count++;
+
+    vid_unlock_text();
 }
 
 void draw_LDP1450_overlay(char *s, int start_x, int y, bool insert, bool reset)
@@ -930,6 +1116,9 @@ void draw_LDP1450_overlay(char *s, int start_x, int y, bool insert, bool reset)
        }
        rcount = 0;
        set_LDP1450_enabled(true);
+
+       // the render thread will draw it with the next frame
+       if (sdl_video_run_thread) return;
     }
 
     if (get_LDP1450_enabled()) {
@@ -948,6 +1137,11 @@ void draw_LDP1450_overlay(char *s, int start_x, int y, bool insert, bool reset)
     if (y3 && (k==0x2||k==0x3)) SDL_RenderPresent(renderer);
 }
 
+static void vid_set_logical_size_job(void *)
+{
+    SDL_RenderSetLogicalSize(g_renderer, g_draw_width, g_draw_height);
+}
+
 // toggles fullscreen mode
 void vid_toggle_fullscreen()
 {
@@ -956,8 +1150,11 @@ void vid_toggle_fullscreen()
         LOGW << fmt("Toggle fullscreen failed: %s", SDL_GetError());
         return;
     }
+    // the window's new size may not suit the old scanlines
+    g_scanline_height = 0;
+
     if ((flags & SDL_WINDOW_FULLSCREEN_DESKTOP) != 0) {
-        SDL_RenderSetLogicalSize(g_renderer, g_draw_width, g_draw_height);
+        vid_run(vid_set_logical_size_job, NULL);
         return;
     }
     SDL_SetWindowSize(g_window, g_draw_width, g_draw_height);
@@ -965,12 +1162,17 @@ void vid_toggle_fullscreen()
                           SDL_WINDOWPOS_CENTERED);
 }
 
-void vid_toggle_scanlines()
+static void vid_scanlines_blend_job(void *)
 {
     SDL_BlendMode mode;
     SDL_GetRenderDrawBlendMode(g_renderer, &mode);
     if (mode != SDL_BLENDMODE_MOD)
         SDL_SetRenderDrawBlendMode(g_renderer, SDL_BLENDMODE_MOD);
+}
+
+void vid_toggle_scanlines()
+{
+    vid_run(vid_scanlines_blend_job, NULL);
 
     if (g_scanlines) g_scanlines = false;
     else g_scanlines = true;
@@ -985,13 +1187,14 @@ void set_detected_width(int pWidth) { g_probe_width = pWidth; }
 unsigned int get_draw_width() { return g_draw_width; }
 unsigned int get_draw_height() { return g_draw_height; }
 
-void vid_setup_yuv_overlay (int width, int height) {
-    // Prepare the YUV overlay, wich means setting up both the YUV surface and YUV texture.
+static void vid_setup_yuv_overlay_job(void *param) {
+    int width  = ((int *)param)[0];
+    int height = ((int *)param)[1];
 
     // If we have already been here, free things first.
     if (g_yuv_surface) {
         // Free both the YUV surface and YUV texture.
-        vid_free_yuv_overlay();
+        vid_free_yuv_overlay_job(NULL);
     }
 
     g_yuv_surface = (g_yuv_surface_t*) malloc (sizeof(g_yuv_surface_t));
@@ -1010,6 +1213,14 @@ void vid_setup_yuv_overlay (int width, int height) {
 
     // Setup the threaded access stuff, since this surface is accessed from the vldp thread, too.
     g_yuv_surface->mutex = SDL_CreateMutex();
+    SDL_AtomicSet(&g_yuv_surface->seq, 0);
+}
+
+void vid_setup_yuv_overlay (int width, int height) {
+    // Prepare the YUV overlay, wich means setting up both the YUV surface and YUV texture.
+    // (on the render thread, so it can't be halfway through using the old ones)
+    int size[2] = {width, height};
+    vid_run(vid_setup_yuv_overlay_job, size);
 }
 
 SDL_Texture *vid_create_yuv_texture (int width, int height) {
@@ -1019,12 +1230,25 @@ SDL_Texture *vid_create_yuv_texture (int width, int height) {
     return g_yuv_texture;
 }
 
+// Writers (who hold the mutex) wrap changes to the planes in these
+static void vid_yuv_write_begin() {
+    SDL_AtomicAdd(&g_yuv_surface->seq, 1);
+    SDL_MemoryBarrierRelease();
+}
+
+static void vid_yuv_write_end() {
+    SDL_MemoryBarrierRelease();
+    SDL_AtomicAdd(&g_yuv_surface->seq, 1);
+}
+
 void vid_blank_yuv_texture (bool s) {
 
     // Black: YUV#108080, YUV(16,0,0)
+    vid_yuv_write_begin();
     memset(g_yuv_surface->Yplane, 0x10, g_yuv_surface->Ysize);
     memset(g_yuv_surface->Uplane, 0x80, g_yuv_surface->Usize);
     memset(g_yuv_surface->Vplane, 0x80, g_yuv_surface->Vsize);
+    vid_yuv_write_end();
 
     if (s) SDL_UpdateYUVTexture(g_yuv_texture, NULL,
 	    g_yuv_surface->Yplane, g_yuv_surface->width,
@@ -1050,9 +1274,11 @@ int vid_update_yuv_overlay ( uint8_t *Yplane, uint8_t *Uplane, uint8_t *Vplane,
 
     } else {
 
+        vid_yuv_write_begin();
         memcpy (g_yuv_surface->Yplane, Yplane, g_yuv_surface->Ysize);
         memcpy (g_yuv_surface->Uplane, Uplane, g_yuv_surface->Usize);
         memcpy (g_yuv_surface->Vplane, Vplane, g_yuv_surface->Vsize);
+        vid_yuv_write_end();
 
         g_yuv_surface->Ypitch = Ypitch;
         g_yuv_surface->Upitch = Upitch;
@@ -1066,6 +1292,135 @@ int vid_update_yuv_overlay ( uint8_t *Yplane, uint8_t *Uplane, uint8_t *Vplane,
     return 0;
 }
 
+// copies the samples for each point out of the planes (which may be changing
+// underneath us: the caller checks the sequence number afterwards)
+static void vid_copy_yuv_pixels(const g_yuv_surface_t *surface, const SDL_Point *points,
+                                int count, Uint8 *out)
+{
+    int w = surface->width, h = surface->height;
+
+    for (int i = 0; i < count; i++, out += 3) {
+        int x = points[i].x, y = points[i].y;
+        if (x < 0) x = 0; else if (x >= w) x = w - 1;
+        if (y < 0) y = 0; else if (y >= h) y = h - 1;
+
+        int c  = (y >> 1) * (w >> 1) + (x >> 1);
+        out[0] = ((volatile Uint8 *)surface->Yplane)[y * w + x];
+        out[1] = ((volatile Uint8 *)surface->Uplane)[c];
+        out[2] = ((volatile Uint8 *)surface->Vplane)[c];
+    }
+}
+
+bool vid_read_yuv_pixels(const SDL_Point *points, int count, Uint8 *out)
+{
+    g_yuv_surface_t *surface = g_yuv_surface;
+    if (!surface || (surface->width < 2) || (surface->height < 2)) return false;
+
+    // A new frame is copied in about once every 30ms, and takes a fraction of
+    // that, so a retry or two is all it should ever take.
+    for (int tries = 0; tries < 8; tries++) {
+        int seq = SDL_AtomicGet(&surface->seq);
+        if (seq & 1) {
+            SDL_Delay(0);
+            continue;
+        }
+        SDL_MemoryBarrierAcquire();
+        vid_copy_yuv_pixels(surface, points, count, out);
+        SDL_MemoryBarrierAcquire();
+        if (SDL_AtomicGet(&surface->seq) == seq) return true;
+    }
+
+    // the vldp thread kept getting in the way: wait our turn
+    SDL_LockMutex(surface->mutex);
+    vid_copy_yuv_pixels(surface, points, count, out);
+    SDL_UnlockMutex(surface->mutex);
+    return true;
+}
+
+// converts 'n' palette indexes to RGBA8888 using 'lut'
+static void overlay_convert_span(Uint32 *dst, const Uint8 *src, int n, const Uint32 *lut)
+{
+#ifdef __AVX2__
+    // 8 pixels at a time: widen the indexes to 32 bits and gather from the LUT
+    for (; n >= 8; n -= 8, src += 8, dst += 8) {
+        __m256i idx = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *)src));
+        _mm256_storeu_si256((__m256i *)dst,
+                            _mm256_i32gather_epi32((const int *)lut, idx, 4));
+    }
+#endif
+    for (; n >= 4; n -= 4, src += 4, dst += 4) {
+        dst[0] = lut[src[0]];
+        dst[1] = lut[src[1]];
+        dst[2] = lut[src[2]];
+        dst[3] = lut[src[3]];
+    }
+    while (n-- > 0) {
+        *dst++ = lut[*src++];
+    }
+}
+
+// grows 'r' to include the 'w' x 'h' area at 'x', 'y'
+static void grow_rect(SDL_Rect &r, int x, int y, int w, int h)
+{
+    if (r.w == 0) {
+        r.x = x; r.y = y; r.w = w; r.h = h;
+        return;
+    }
+
+    int x2 = r.x + r.w, y2 = r.y + r.h;
+    if (x < r.x) r.x = x;
+    if (y < r.y) r.y = y;
+    if (x + w > x2) x2 = x + w;
+    if (y + h > y2) y2 = y + h;
+    r.w = x2 - r.x;
+    r.h = y2 - r.y;
+}
+
+// A 32-bit overlay (Singe draws in RGBA) goes straight into the blitter, with
+// no palette in between.  Like the 8-bit path, only the spans that differ
+// from what's already there get copied and uploaded.
+static void vid_update_overlay_rgba(SDL_Surface *tx)
+{
+    // the overlay texture is the only way to show this
+    g_compose_active = false;
+
+    int w = (tx->w < g_screen_blitter->w) ? tx->w : g_screen_blitter->w;
+    int h = (tx->h < g_screen_blitter->h) ? tx->h : g_screen_blitter->h;
+    Uint32 uFormat = g_screen_blitter->format->format;
+
+    // anything else needs converting, and then there's nothing to compare
+    if (tx->format->format != uFormat) {
+        SDL_ConvertPixels(w, h, tx->format->format, tx->pixels, tx->pitch, uFormat,
+                          g_screen_blitter->pixels, g_screen_blitter->pitch);
+        grow_rect(g_overlay_dirty_rect, 0, 0, w, h);
+        g_overlay_needs_update = true;
+        g_overlay_shadow_valid = true;
+        return;
+    }
+
+    for (int row = 0; row < h; row++) {
+        const Uint32 *s = (const Uint32 *)((const Uint8 *)tx->pixels + (row * tx->pitch));
+        Uint32 *d = (Uint32 *)((Uint8 *)g_screen_blitter->pixels + (row * g_screen_blitter->pitch));
+        int left = 0, right = w;
+
+        if (g_overlay_shadow_valid) {
+            if (memcmp(s, d, w * 4) == 0) continue;
+
+            while (s[left] == d[left]) left++;
+            while (s[right - 1] == d[right - 1]) right--;
+        }
+
+        memcpy(d + left, s + left, (right - left) * 4);
+        grow_rect(g_overlay_dirty_rect, left, row, right - left, 1);
+    }
+
+    g_overlay_shadow_valid = true;
+
+    if (g_overlay_dirty_rect.w) {
+        g_overlay_needs_update = true;
+    }
+}
+
 void vid_update_overlay_surface (SDL_Surface *tx, int x, int y) {
     // We have got here from game::blit(), which is also called when scoreboard is updated,
     // so in that case we simply return and don't do any overlay surface update. 
@@ -1080,31 +1435,165 @@ void vid_update_overlay_surface (SDL_Surface *tx, int x, int y) {
     g_overlay_size_rect.w = tx->w;
     g_overlay_size_rect.h = tx->h;
 
+    // going from one kind of overlay to the other, the blitter is no help
+    if (tx->format->BitsPerPixel != g_overlay_last_bpp) {
+        g_overlay_last_bpp     = tx->format->BitsPerPixel;
+        g_overlay_shadow_valid = false;
+    }
+
+    if (g_overlay_last_bpp == 32) {
+        vid_update_overlay_rgba(tx);
+        return;
+    }
+
     // MAC: 8bpp to RGBA8888 conversion. Black pixels are considered totally transparent so they become 0x00000000;
-    for (int i = 0; i < (tx->w * tx->h); i++) {
-	    *((uint32_t*)(g_screen_blitter->pixels)+i) =
-	    (0x00000000 | tx->format->palette->colors[*((uint8_t*)(tx->pixels)+i)].r) << 24|
-	    (0x00000000 | tx->format->palette->colors[*((uint8_t*)(tx->pixels)+i)].g) << 16|
-	    (0x00000000 | tx->format->palette->colors[*((uint8_t*)(tx->pixels)+i)].b) << 8|
-	    (0x00000000 | tx->format->palette->colors[*((uint8_t*)(tx->pixels)+i)].a);
+    SDL_Palette *pal = tx->format->palette;
+    if ((pal != g_overlay_lut_palette) || (pal->version != g_overlay_lut_version)) {
+        for (int i = 0; i < 256; i++) {
+            SDL_Color c = (i < pal->ncolors) ? pal->colors[i] : pal->colors[0];
+            g_overlay_lut[i] = (c.r << 24) | (c.g << 16) | (c.b << 8) | c.a;
+        }
+        g_overlay_lut_palette  = pal;
+        g_overlay_lut_version  = pal->version;
+        g_overlay_shadow_valid = false; // every pixel may have changed colour
+    }
+
+    bool bCompose = g_yuv_compose && !g_compose_blocked && g_yuv_surface && palette::get_yuv();
+    if (bCompose != g_compose_active) {
+        g_compose_active       = bCompose;
+        g_compose_dirty        = true;
+        g_overlay_shadow_valid = false; // the RGBA surface hasn't been kept up
     }
 
-    g_overlay_needs_update = true;
+    if ((tx->w != g_overlay_shadow_w) || (tx->h != g_overlay_shadow_h)) {
+        delete[] g_overlay_shadow;
+        g_overlay_shadow       = new Uint8[tx->w * tx->h];
+        g_overlay_shadow_w     = tx->w;
+        g_overlay_shadow_h     = tx->h;
+        g_overlay_shadow_valid = false;
+    }
+
+    const Uint8 *src = (const Uint8 *)tx->pixels;
+    Uint8 *dst       = (Uint8 *)g_screen_blitter->pixels;
+
+    for (int row = 0; row < tx->h; row++) {
+        const Uint8 *s = src + (row * tx->pitch);
+        Uint8 *shadow  = g_overlay_shadow + (row * tx->w);
+        int left = 0, right = tx->w;
+
+        if (g_overlay_shadow_valid) {
+            if (memcmp(s, shadow, tx->w) == 0) continue;
+
+            // only convert from the first to the last pixel that changed
+            while (s[left] == shadow[left]) left++;
+            while (s[right - 1] == shadow[right - 1]) right--;
+        }
+
+        memcpy(shadow + left, s + left, right - left);
+
+        // the shadow is all vid_compose_yuv() needs
+        if (g_compose_active) {
+            g_compose_dirty = true;
+            continue;
+        }
+
+        overlay_convert_span((Uint32 *)(dst + (row * g_screen_blitter->pitch)) + left,
+                             s + left, right - left, g_overlay_lut);
+        grow_rect(g_overlay_dirty_rect, left, row, right - left, 1);
+    }
+
+    g_overlay_shadow_valid = true;
+
+    if (g_overlay_dirty_rect.w) {
+        g_overlay_needs_update = true;
+    }
     // MAC: We update the overlay texture later, just when we are going to SDL_RenderCopy() it to the renderer.
     // SDL_UpdateTexture(g_overlay_texture, &g_overlay_size_rect, (void *)g_screen_blitter->pixels, g_screen_blitter->pitch);
 }
 
-void vid_blit () {
-    // *IF* we get to SDL_VIDEO_BLIT from game::blit(), then the access to the
-    // overlay and scoreboard textures is done from the "hypseus" thread, that blocks
-    // until all blitting operations are completed and only then loops again, so NO
-    // need to protect the access to these surfaces or their needs_update booleans.
-    // However, since we get here from game::blit(), the yuv "surface" is accessed
-    // simultaneously from the vldp thread and from here, the main thread (to update
-    // the YUV texture from the YUV surface), so access to that surface and it's
-    // boolean DO need to be protected with a mutex.
+// uploads the 'rect' part of 'surface' (an overlay sized RGBA8888 surface) to
+// the overlay texture
+static void vid_upload_overlay(SDL_Surface *surface, const SDL_Rect &rect)
+{
+    SDL_Rect dst = rect;
+    dst.x += g_overlay_size_rect.x;
+    dst.y += g_overlay_size_rect.y;
+    SDL_UpdateTexture(g_overlay_texture, &dst,
+        (Uint8 *)surface->pixels + (rect.y * surface->pitch) + (rect.x * 4), surface->pitch);
+}
+
+// Copies the video into g_compose_buf, draws the overlay over it and uploads
+// the result to the YUV texture.  Called with the YUV surface locked.
+static void vid_compose_yuv()
+{
+    int iSize = g_yuv_surface->Ysize + g_yuv_surface->Usize + g_yuv_surface->Vsize;
+    if (iSize != g_compose_size) {
+        delete[] g_compose_buf;
+        g_compose_buf  = new Uint8[iSize];
+        g_compose_size = iSize;
+    }
+
+    // same layout as the YUV surface (see vid_blank_yuv_texture)
+    yuvblend::frame_s frame;
+    frame.pY      = g_compose_buf;
+    frame.pU      = frame.pY + g_yuv_surface->Ysize;
+    frame.pV      = frame.pU + g_yuv_surface->Usize;
+    frame.iWidth  = g_yuv_surface->width;
+    frame.iHeight = g_yuv_surface->height;
+    frame.iYPitch = g_yuv_surface->width;
+    frame.iUPitch = frame.iVPitch = g_yuv_surface->width / 2;
+
+    memcpy(frame.pY, g_yuv_surface->Yplane, g_yuv_surface->Ysize);
+    memcpy(frame.pU, g_yuv_surface->Uplane, g_yuv_surface->Usize);
+    memcpy(frame.pV, g_yuv_surface->Vplane, g_yuv_surface->Vsize);
+
+    // the same part of the overlay the overlay texture would have shown
+    yuvblend::compose(frame, g_overlay_shadow, g_overlay_shadow_w, g_overlay_shadow_w,
+                      g_overlay_shadow_h, g_leds_size_rect.w, g_leds_size_rect.h,
+                      palette::get_yuv(), palette::get_color_count());
+
+    SDL_UpdateYUVTexture(g_yuv_texture, NULL, frame.pY, frame.iYPitch, frame.pU,
+                         frame.iUPitch, frame.pV, frame.iVPitch);
+}
+
+// Reads back the frame about to be presented and writes its hash out
+// (64-bit FNV-1a over the ARGB8888 pixels, row by row)
+static void hash_frame()
+{
+    int iW = 0, iH = 0;
+    if (SDL_GetRendererOutputSize(g_renderer, &iW, &iH) != 0) return;
+
+    int iSize = iW * iH * 4;
+    if (iSize != g_frame_hash_size) {
+        free(g_frame_hash_buf);
+        g_frame_hash_buf  = (Uint8 *)malloc(iSize);
+        g_frame_hash_size = g_frame_hash_buf ? iSize : 0;
+        if (!g_frame_hash_buf) return;
+    }
 
+    if (SDL_RenderReadPixels(g_renderer, NULL, SDL_PIXELFORMAT_ARGB8888,
+                             g_frame_hash_buf, iW * 4) != 0) {
+        LOGW << fmt("Could not read the frame back for hashing: %s", SDL_GetError());
+        fclose(g_frame_hash_file);
+        g_frame_hash_file = NULL;
+        return;
+    }
 
+    Uint64 u64Hash = 0xcbf29ce484222325ULL;
+    for (int i = 0; i < iSize; i++) {
+        u64Hash = (u64Hash ^ g_frame_hash_buf[i]) * 0x100000001b3ULL;
+    }
+    g_frame_hash_all = (g_frame_hash_all ^ u64Hash) * 0x100000001b3ULL;
+
+    fprintf(g_frame_hash_file, "%u %016llx\n", g_render_stats.uFrames,
+            (unsigned long long)u64Hash);
+}
+
+// Builds the frame from the textures and presents it.  If 'leds' is set, it
+// is uploaded for the old style LDP1450 overlay.
+// This is the part of vid_blit() that runs on the render thread if there is one.
+static void vid_present(SDL_Surface *leds)
+{
     // First clear the renderer before the SDL_RenderCopy() calls for this frame.
     // Prevents stroboscopic effects on the background in fullscreen mode,
     // and is recommended by SDL_Rendercopy() documentation.
@@ -1114,7 +1603,7 @@ void vid_blit () {
     // Don't try if the vldp object didn't call setup_yuv_surface (in noldp mode)
     if (g_yuv_surface) {
 	SDL_LockMutex(g_yuv_surface->mutex);
-	if (g_yuv_video_needs_update) {
+	if (g_yuv_video_needs_update || (g_compose_active && g_compose_dirty)) {
 	    // If we don't have a YUV texture yet (we may be here for the first time or the vldp could have
 	    // ordered it's destruction in the mpeg_callback function because video dimensions have changed),
 	    // create it now. Dimensions were passed to the video object (this) by the vldp object earlier,
@@ -1123,29 +1612,20 @@ void vid_blit () {
 		g_yuv_texture = vid_create_yuv_texture(g_yuv_surface->width, g_yuv_surface->height);
 	    }
 
-	    SDL_UpdateYUVTexture(g_yuv_texture, NULL,
-		g_yuv_surface->Yplane, g_yuv_surface->Ypitch,
-		g_yuv_surface->Uplane, g_yuv_surface->Vpitch,
-		g_yuv_surface->Vplane, g_yuv_surface->Vpitch);
+	    if (g_compose_active && g_overlay_shadow_valid) {
+		vid_compose_yuv();
+	    } else {
+		SDL_UpdateYUVTexture(g_yuv_texture, NULL,
+		    g_yuv_surface->Yplane, g_yuv_surface->Ypitch,
+		    g_yuv_surface->Uplane, g_yuv_surface->Vpitch,
+		    g_yuv_surface->Vplane, g_yuv_surface->Vpitch);
+	    }
 	    g_yuv_video_needs_update = false;
+	    g_compose_dirty          = false;
 	}
 	SDL_UnlockMutex(g_yuv_surface->mutex);
     }
 
-    // Does OVERLAY texture need update from the scoreboard surface?
-    if(g_scoreboard_needs_update) {
-	SDL_UpdateTexture(g_overlay_texture, &g_leds_size_rect,
-	    (void *)g_leds_surface->pixels, g_leds_surface->pitch);
-	g_scoreboard_needs_update = false;
-    }
-
-    // Does OVERLAY texture need update from the overlay surface?
-    if(g_overlay_needs_update) {
-	SDL_UpdateTexture(g_overlay_texture, &g_overlay_size_rect,
-	    (void *)g_screen_blitter->pixels, g_screen_blitter->pitch);
-	g_overlay_needs_update = false;
-    }
-
     // Sadly, we have to RenderCopy the YUV texture on every blitting strike, because
     // the image on the renderer gets "dirty" with previous overlay frames on top of the yuv.
     if(g_yuv_texture) {
@@ -1155,28 +1635,285 @@ void vid_blit () {
     // If there's an overlay texture, it means we are using some kind of overlay,
     // be it LEDs or any other thing, so RenderCopy it to the renderer ON TOP of the YUV video.
     // ONLY a rect of the LEDs surface size is copied for now.
-    if(g_overlay_texture) {
+    if(g_overlay_texture && !g_compose_active) {
 	SDL_RenderCopy(g_renderer, g_overlay_texture, &g_leds_size_rect, NULL);
     }
 
+    // Singe's sprites, if they're being drawn here rather than in the overlay
+    if (spritebatch::is_enabled()) spritebatch::draw(g_renderer, g_leds_size_rect);
+
+    vid_lock_text();
+
     // If there's a subtitle overlay
     if (g_bSubtitleShown) draw_subtitle(subchar, subscreen, 0);
 
     // LDP1450 overlays
-    if (g_ldp1450_old_overlay) SDL_UpdateTexture(g_overlay_texture, &g_leds_size_rect,
-                 (void *)g_leds_surface->pixels, g_leds_surface->pitch);
+    if (g_ldp1450_old_overlay) {
+        if (leds) SDL_UpdateTexture(g_overlay_texture, &g_leds_size_rect,
+                 (void *)leds->pixels, leds->pitch);
+    }
     else if (get_LDP1450_enabled()) draw_LDP1450_overlay(NULL, 0, 0, 0, 0);
 
+    vid_unlock_text();
+
     if (g_scanlines) draw_scanlines();
 
-    SDL_RenderPresent(g_renderer);
-
-    if (g_sb_renderer) SDL_RenderPresent(g_sb_renderer);
+    // (the renderer's contents are undefined once it has been presented, so
+    // everything that reads the frame back has to do it here)
+    if (g_frame_hash_file) hash_frame();
 
     if (queue_take_screenshot) {
         set_queue_screenshot(false);
         take_screenshot();
     }
+
+    if (capture::get_continuous() != capture::CAPTURE_OFF) capture_frame();
+
+    SDL_RenderPresent(g_renderer);
+
+    if (g_sb_renderer) SDL_RenderPresent(g_sb_renderer);
+}
+
+// adds the time from a frame being handed over to it being on screen
+static void vid_count_frame(Uint64 u64Posted)
+{
+    double dMs = ((SDL_GetPerformanceCounter() - u64Posted) * 1000.0) /
+                 SDL_GetPerformanceFrequency();
+
+    g_render_stats.uFrames++;
+    g_render_latency_total += dMs;
+    g_render_stats.dAvgLatencyMs = g_render_latency_total / g_render_stats.uFrames;
+    if (dMs > g_render_stats.dMaxLatencyMs) g_render_stats.dMaxLatencyMs = dMs;
+}
+
+// the render thread: presents whatever vid_blit() left in the mailbox, and
+// runs vid_run() jobs
+static int sdl_video_run(void *)
+{
+    SDL_LockMutex(sdl_video_run_mutex);
+
+    while (sdl_video_run_loop) {
+        if (sdl_video_run_job) {
+            void (*job)(void *) = sdl_video_run_job;
+            void *param         = sdl_video_run_param;
+
+            SDL_UnlockMutex(sdl_video_run_mutex);
+            job(param);
+            SDL_LockMutex(sdl_video_run_mutex);
+
+            sdl_video_run_job = NULL;
+            sdl_video_run_done_seq++;
+            SDL_CondBroadcast(sdl_video_run_done_cond);
+        } else if (g_mailbox_frame_pending) {
+            Uint64 u64Posted = g_mailbox_posted;
+            g_mailbox_frame_pending = false;
+
+            // take the textures' worth out of the mailbox while we hold it,
+            // same order as vid_blit()
+            if (g_mailbox_leds_pending || g_ldp1450_old_overlay) {
+                SDL_UpdateTexture(g_overlay_texture, &g_leds_size_rect,
+                    g_mailbox_leds->pixels, g_mailbox_leds->pitch);
+                g_mailbox_leds_pending = false;
+            }
+            if (g_mailbox_overlay_rect.w) {
+                vid_upload_overlay(g_mailbox_overlay, g_mailbox_overlay_rect);
+                g_mailbox_overlay_rect.w = g_mailbox_overlay_rect.h = 0;
+            }
+
+            // and let the emulation carry on while we wait for the GPU
+            SDL_UnlockMutex(sdl_video_run_mutex);
+            vid_present(NULL);
+            SDL_LockMutex(sdl_video_run_mutex);
+
+            vid_count_frame(u64Posted);
+        } else {
+            SDL_CondWait(sdl_video_run_cond, sdl_video_run_mutex);
+        }
+    }
+
+    SDL_UnlockMutex(sdl_video_run_mutex);
+
+    // give the renderer's GL context (if it has one) back to the main thread
+    if (SDL_GL_GetCurrentContext()) SDL_GL_MakeCurrent(g_window, NULL);
+
+    return 0;
+}
+
+// hands the new overlay/LEDs over to the render thread
+static void vid_post_frame()
+{
+    SDL_LockMutex(sdl_video_run_mutex);
+
+    // the render thread never got to the last one
+    if (g_mailbox_frame_pending) g_render_stats.uDropped++;
+
+    if (g_scoreboard_needs_update || g_ldp1450_old_overlay) {
+        memcpy(g_mailbox_leds->pixels, g_leds_surface->pixels,
+               g_leds_surface->h * g_leds_surface->pitch);
+        if (g_scoreboard_needs_update) g_mailbox_leds_pending = true;
+        g_scoreboard_needs_update = false;
+    }
+
+    if (g_overlay_needs_update) {
+        SDL_Rect &r = g_overlay_dirty_rect;
+        for (int row = r.y; row < r.y + r.h; row++) {
+            memcpy((Uint8 *)g_mailbox_overlay->pixels + (row * g_mailbox_overlay->pitch) + (r.x * 4),
+                   (Uint8 *)g_screen_blitter->pixels + (row * g_screen_blitter->pitch) + (r.x * 4),
+                   r.w * 4);
+        }
+        grow_rect(g_mailbox_overlay_rect, r.x, r.y, r.w, r.h);
+        g_overlay_needs_update = false;
+        r.w = r.h = 0;
+    }
+
+    g_mailbox_frame_pending = true;
+    g_mailbox_posted        = SDL_GetPerformanceCounter();
+    SDL_CondSignal(sdl_video_run_cond);
+    SDL_UnlockMutex(sdl_video_run_mutex);
+}
+
+static void vid_start_render_thread()
+{
+    if (sdl_video_run_thread) return;
+
+    g_mailbox_overlay = SDL_ConvertSurface(g_screen_blitter, g_screen_blitter->format, 0);
+    g_mailbox_leds    = SDL_ConvertSurface(g_leds_surface, g_leds_surface->format, 0);
+    sdl_video_run_mutex     = SDL_CreateMutex();
+    sdl_video_run_cond      = SDL_CreateCond();
+    sdl_video_run_done_cond = SDL_CreateCond();
+
+    // The renderer's GL context (if it has one) is current on this thread,
+    // and a context can only be current on one thread at a time.  SDL makes
+    // it current again on whichever thread uses the renderer next.
+    if (SDL_GL_GetCurrentContext()) SDL_GL_MakeCurrent(g_window, NULL);
+
+    sdl_video_run_loop   = true;
+    sdl_video_run_thread = SDL_CreateThread(sdl_video_run, "sdl_video_run", NULL);
+
+    if (sdl_video_run_thread) {
+        sdl_video_run_id = SDL_GetThreadID(sdl_video_run_thread);
+        LOGI << "Rendering on a separate thread";
+
+        // composition reads the overlay as the emulation writes it
+        if (g_yuv_compose) {
+            LOGW << "-yuv_compose can't be used with -render_thread, ignoring it";
+            g_yuv_compose = false;
+        }
+
+        // the draws are queued up as the emulation goes
+        if (spritebatch::is_enabled()) {
+            LOGW << "-gpu_sprites can't be used with -render_thread, ignoring it";
+            spritebatch::set_enabled(false);
+        }
+    } else {
+        LOGW << fmt("Could not start render thread: %s", SDL_GetError());
+        sdl_video_run_loop = false;
+    }
+}
+
+static void vid_stop_render_thread()
+{
+    if (sdl_video_run_thread) {
+        SDL_LockMutex(sdl_video_run_mutex);
+        sdl_video_run_loop = false;
+        SDL_CondSignal(sdl_video_run_cond);
+        SDL_UnlockMutex(sdl_video_run_mutex);
+        SDL_WaitThread(sdl_video_run_thread, NULL);
+        sdl_video_run_thread = NULL;
+
+        LOGI << fmt("Render thread: %u frames presented, %u dropped, "
+                    "%.1f ms average / %.1f ms worst latency",
+                    g_render_stats.uFrames, g_render_stats.uDropped,
+                    g_render_stats.dAvgLatencyMs, g_render_stats.dMaxLatencyMs);
+    }
+
+    SDL_FreeSurface(g_mailbox_overlay);
+    SDL_FreeSurface(g_mailbox_leds);
+    g_mailbox_overlay = g_mailbox_leds = NULL;
+    if (sdl_video_run_mutex) SDL_DestroyMutex(sdl_video_run_mutex);
+    if (sdl_video_run_cond) SDL_DestroyCond(sdl_video_run_cond);
+    if (sdl_video_run_done_cond) SDL_DestroyCond(sdl_video_run_done_cond);
+    sdl_video_run_mutex = NULL;
+    sdl_video_run_cond = sdl_video_run_done_cond = NULL;
+}
+
+void vid_run(void (*job)(void *), void *param)
+{
+    if (!sdl_video_run_thread || (SDL_ThreadID() == sdl_video_run_id)) {
+        job(param);
+        return;
+    }
+
+    SDL_LockMutex(sdl_video_run_mutex);
+
+    // wait for the slot to be free if another thread got in first
+    while (sdl_video_run_job) SDL_CondWait(sdl_video_run_done_cond, sdl_video_run_mutex);
+
+    sdl_video_run_job   = job;
+    sdl_video_run_param = param;
+    Uint32 uSeq         = ++sdl_video_run_job_seq;
+    SDL_CondSignal(sdl_video_run_cond);
+
+    while ((Sint32)(sdl_video_run_done_seq - uSeq) < 0)
+        SDL_CondWait(sdl_video_run_done_cond, sdl_video_run_mutex);
+
+    SDL_UnlockMutex(sdl_video_run_mutex);
+}
+
+void get_render_stats(render_stats_s &stats)
+{
+    if (sdl_video_run_mutex) SDL_LockMutex(sdl_video_run_mutex);
+    stats = g_render_stats;
+    if (sdl_video_run_mutex) SDL_UnlockMutex(sdl_video_run_mutex);
+}
+
+void vid_blit () {
+    // *IF* we get to SDL_VIDEO_BLIT from game::blit(), then the access to the
+    // overlay and scoreboard textures is done from the "hypseus" thread, that blocks
+    // until all blitting operations are completed and only then loops again, so NO
+    // need to protect the access to these surfaces or their needs_update booleans.
+    // However, since we get here from game::blit(), the yuv "surface" is accessed
+    // simultaneously from the vldp thread and from here, the main thread (to update
+    // the YUV texture from the YUV surface), so access to that surface and it's
+    // boolean DO need to be protected with a mutex.
+    // With -render_thread, the surfaces are copied to the mailbox here and the
+    // render thread does the rest.
+
+    // the LEDs get uploaded over the overlay texture
+    if (g_scoreboard_needs_update || g_ldp1450_old_overlay) {
+	g_overlay_shadow_valid = false; // the texture no longer matches the overlay
+
+	if (g_yuv_compose && !g_compose_blocked) {
+	    LOGI << "The LED overlay needs the overlay texture, -yuv_compose disabled";
+	    g_compose_blocked = true;
+	    g_compose_active  = false;
+	}
+    }
+
+    if (sdl_video_run_thread) {
+        vid_post_frame();
+        return;
+    }
+
+    Uint64 u64Start = SDL_GetPerformanceCounter();
+
+    // Does OVERLAY texture need update from the scoreboard surface?
+    if(g_scoreboard_needs_update) {
+	SDL_UpdateTexture(g_overlay_texture, &g_leds_size_rect,
+	    (void *)g_leds_surface->pixels, g_leds_surface->pitch);
+	g_scoreboard_needs_update = false;
+    }
+
+    // Does OVERLAY texture need update from the overlay surface?
+    // Only the part that changed since the last upload is sent.
+    if(g_overlay_needs_update) {
+	vid_upload_overlay(g_screen_blitter, g_overlay_dirty_rect);
+	g_overlay_needs_update = false;
+	g_overlay_dirty_rect.w = g_overlay_dirty_rect.h = 0;
+    }
+
+    vid_present(g_leds_surface);
+    vid_count_frame(u64Start);
 }
 
 int get_yuv_overlay_width() {
@@ -1198,22 +1935,32 @@ bool get_yuv_overlay_ready() {
     else return false;
 }
 
-void take_screenshot()
+// whether a continuous capture has been through can_read_screen() yet
+static bool g_capture_checked = false;
+
+// Checks that there is somewhere to put screenshots and that the window can
+// be read back at all.
+static bool can_read_screen()
 {
     struct       stat info;
-    char         filename[64];
-    int32_t      screenshot_num = 0;
     const char   dir[12] = "screenshots";
 
     if (stat(dir, &info ) != 0 )
-        { LOGW << fmt("'%s' directory does not exist.", dir); return; }
+        { LOGW << fmt("'%s' directory does not exist.", dir); return false; }
     else if (!(info.st_mode & S_IFDIR))
-        { LOGW << fmt("'%s' is not a directory.", dir); return; }
+        { LOGW << fmt("'%s' is not a directory.", dir); return false; }
 
     int flags = SDL_GetWindowFlags(g_window);
     if (flags & SDL_WINDOW_FULLSCREEN_DESKTOP || flags & SDL_WINDOW_MAXIMIZED)
-        { LOGW << "Cannot screenshot in fullscreen render."; return; }
+        { LOGW << "Cannot screenshot in fullscreen render."; return false; }
 
+    return true;
+}
+
+// Reads the renderer back into a new surface (for screenshots and captures).
+// Returns NULL if it couldn't.
+static SDL_Surface *read_screen()
+{
     SDL_Rect     screenshot;
     SDL_Renderer *g_renderer   = get_renderer();
     SDL_Surface  *surface      = NULL;
@@ -1221,59 +1968,106 @@ void take_screenshot()
     if (g_renderer) {
         SDL_RenderGetViewport(g_renderer, &screenshot);
         surface = SDL_CreateRGBSurface(0, screenshot.w, screenshot.h, 32, 0, 0, 0, 0);
-        if (!surface) { LOGE << "Cannot allocate surface"; return; }
+        if (!surface) { LOGE << "Cannot allocate surface"; return NULL; }
         if (SDL_RenderReadPixels(g_renderer, NULL, surface->format->format,
             surface->pixels, surface->pitch) != 0)
             { LOGE << fmt("Cannot ReadPixels - Something bad happened: %s", SDL_GetError());
-                 deinit_display();
-                 shutdown_display();
-                 SDL_Quit();
-                 exit(1); }
+                 SDL_FreeSurface(surface);
+                 return NULL; }
     } else {
         LOGE << "Could not allocate renderer";
-        return;
+        return NULL;
+    }
+
+    return surface;
+}
+
+// The PNG gets written by the capture thread.
+void take_screenshot()
+{
+    if (!can_read_screen()) return;
+
+    SDL_Surface *surface = read_screen();
+    if (surface) capture::queue_screenshot(surface);
+}
+
+// adds the frame about to be presented to a continuous capture
+static void capture_frame()
+{
+    // (checked once, not every frame)
+    if (!g_capture_checked) {
+        if (!can_read_screen()) {
+            capture::set_continuous(capture::CAPTURE_OFF);
+            return;
+        }
+        g_capture_checked = true;
     }
 
-    for (;;) {
-        screenshot_num++;
-        sprintf(filename, "%s%shypseus-%d.png",
-          dir, PATH_SEPARATOR, screenshot_num);
+    SDL_Surface *surface = read_screen();
 
-        if (!mpo_file_exists(filename))
-            break;
+    if (surface) {
+        capture::queue_frame(surface);
+    } else {
+        capture::set_continuous(capture::CAPTURE_OFF); // don't nag every frame
+    }
+}
+
+// (re)builds the scanline texture for the current draw height
+static void build_scanlines()
+{
+    Uint32 *pattern = new Uint32[g_draw_height];
+    unsigned char c = 0;
+
+    // 4 darkened rows then an untouched one (the blend mode multiplies the
+    // screen by these, so white leaves it alone)
+    for (unsigned int i = 0; i < g_draw_height; i++) {
+        switch (i % 5)
+        {
+           case 0:
+             c = 0x40;
+             break;
+           case 1:
+             c = 0x90;
+             break;
+           case 2:
+             c = 0xB0;
+             break;
+           case 3:
+             c = 0xD0;
+             break;
+           default:
+             c = 0xFF;
+             break;
+        }
+        pattern[i] = (c << 24) | (c << 16) | (c << 8) | SDL_ALPHA_OPAQUE;
     }
 
-    if (IMG_SavePNG(surface, filename) == 0) {
-        LOGI << fmt("Wrote screenshot: %s", filename);
+    SDL_DestroyTexture(g_scanline_texture);
+    g_scanline_texture = SDL_CreateTexture(g_renderer, SDL_PIXELFORMAT_RGBA8888,
+                                           SDL_TEXTUREACCESS_STATIC, 1, g_draw_height);
+    if (g_scanline_texture) {
+        SDL_UpdateTexture(g_scanline_texture, NULL, pattern, sizeof(Uint32));
+        SDL_SetTextureBlendMode(g_scanline_texture, SDL_BLENDMODE_MOD);
+#if SDL_VERSION_ATLEAST(2, 0, 12)
+        // keep the lines sharp when the draw area is scaled to fullscreen
+        SDL_SetTextureScaleMode(g_scanline_texture, SDL_ScaleModeNearest);
+#endif
+        g_scanline_height = g_draw_height;
     } else {
-        LOGE <<  fmt("Could not write screenshot: %s !!", filename);
+        LOGW << fmt("Could not create scanline texture: %s", SDL_GetError());
     }
 
-    SDL_FreeSurface(surface);
+    delete[] pattern;
 }
 
 void draw_scanlines() {
-    unsigned char c;
-    for (unsigned int i = 0; i < g_draw_height; i+=5) {
-         c = 0x40;
-         for (int j = 0; j < 4; j++) {
-             SDL_SetRenderDrawColor(g_renderer, c, c, c, SDL_ALPHA_OPAQUE);
-             SDL_RenderDrawLine(g_renderer, 0, i+j, g_draw_width, i+j);
-             switch(j)
-             {
-                case 0:
-                  c = 0x90;
-                  break;
-                case 1:
-                  c = 0xB0;
-                  break;
-                default:
-                  c = 0xD0;
-                  break;
-            }
-        }
+    if (!g_scanline_texture || (g_scanline_height != g_draw_height)) {
+        build_scanlines();
+        if (!g_scanline_texture) return;
     }
-    SDL_SetRenderDrawColor(g_renderer, 0, 0, 0, SDL_ALPHA_OPAQUE);
+
+    SDL_Rect dst = {0, 0, (int)g_draw_width, (int)g_draw_height};
+    SDL_RenderCopy(g_renderer, g_scanline_texture, NULL, &dst);
 }
 
 }
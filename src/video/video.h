@@ -88,8 +88,54 @@ int vid_update_yuv_texture (uint8_t *Yplane, uint8_t *Uplane, uint8_t *Vplane, i
 void vid_blank_yuv_texture (bool value);
 void vid_free_yuv_overlay ();
 
+// Reads the Y, U and V of the decoded disc video at each of 'count' points
+// (video pixels, clamped to the frame) into 'out', 3 bytes per point.
+// Reads the YUV surface without a GPU read back or waiting on the vldp
+// thread; false if there's no video.
+bool vid_read_yuv_pixels(const SDL_Point *points, int count, Uint8 *out);
+
+// 'tx' is the game's overlay, either 8-bit (palettised, with color 0
+// transparent) or 32-bit with an alpha channel
 void vid_update_overlay_surface(SDL_Surface *tx, int x, int y);
 void vid_blit();
+
+// -render_thread: composition and SDL_RenderPresent() happen on their own
+// thread, which must then be the only one to use the renderer.
+// Anything else that needs the renderer should go through vid_run(), which
+// calls 'job(param)' on the render thread and waits for it (or just calls it
+// if there is no render thread).
+void set_render_thread(bool bEnabled);
+void vid_run(void (*job)(void *), void *param);
+
+// -yuv_compose: lay the 8-bit overlay over the disc video in YUV, and render
+// just the one texture.  Saves the renderer a colour conversion and a blend
+// each frame, which is worth having with a software renderer.
+void set_yuv_compose(bool bEnabled);
+
+// -headless: render into an offscreen buffer through SDL's offscreen or
+// dummy video driver, so no display server is needed (for CI runs).
+// The frame is composed the same way, with the software renderer.
+// Must be set before init_display().
+void set_headless(bool bEnabled);
+
+// How often the display refreshes, in Hz (0 if SDL can't tell), and whether
+// vid_blit() waits for that refresh before returning (a vsync'd renderer,
+// presenting on the calling thread).
+int get_refresh_rate();
+bool get_blit_waits_vsync();
+
+// -frame_hash <file>: write a hash of each presented frame to 'szPath', plus
+// one for the whole run when the display is shut down, so rendering changes
+// show up as a diff
+void set_frame_hash_file(const char *szPath);
+
+struct render_stats_s {
+    unsigned int uFrames;  // frames presented
+    unsigned int uDropped; // frames replaced by a newer one before being presented
+    double dAvgLatencyMs;  // from vid_blit() to the frame being presented
+    double dMaxLatencyMs;
+};
+void get_render_stats(render_stats_s &stats);
 // MAC: sdl_video_run thread block ends here
 
 #ifdef USE_OPENGL
@@ -0,0 +1,148 @@
+/*
+ * ____ DAPHNE COPYRIGHT NOTICE ____
+ *
+ * This file is part of DAPHNE, a laserdisc arcade game emulator
+ *
+ * DAPHNE is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * DAPHNE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// yuvblend.cpp
+
+#include "config.h"
+
+#include "yuvblend.h"
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+using namespace std;
+
+namespace yuvblend
+{
+// scratch space, kept between frames so it's only allocated once
+vector<int> g_xmap;          // overlay column for each frame column (-1 = none)
+vector<Uint8> g_row_visible; // whether each overlay row has anything to draw
+vector<Uint8> g_val, g_mask, g_val2;
+
+// dst[i] = mask[i] ? val[i] : dst[i], where each mask byte is 0 or 0xFF
+static void select_span(Uint8 *dst, const Uint8 *val, const Uint8 *mask, int n)
+{
+#if defined(__SSE2__)
+#ifdef __AVX2__
+    for (; n >= 32; n -= 32, dst += 32, val += 32, mask += 32) {
+        __m256i m = _mm256_loadu_si256((const __m256i *)mask);
+        __m256i v = _mm256_loadu_si256((const __m256i *)val);
+        __m256i d = _mm256_loadu_si256((const __m256i *)dst);
+        _mm256_storeu_si256((__m256i *)dst, _mm256_blendv_epi8(d, v, m));
+    }
+#endif
+    for (; n >= 16; n -= 16, dst += 16, val += 16, mask += 16) {
+        __m128i m = _mm_loadu_si128((const __m128i *)mask);
+        __m128i v = _mm_loadu_si128((const __m128i *)val);
+        __m128i d = _mm_loadu_si128((const __m128i *)dst);
+        _mm_storeu_si128((__m128i *)dst,
+                         _mm_or_si128(_mm_and_si128(m, v), _mm_andnot_si128(m, d)));
+    }
+#elif defined(__ARM_NEON)
+    for (; n >= 16; n -= 16, dst += 16, val += 16, mask += 16) {
+        vst1q_u8(dst, vbslq_u8(vld1q_u8(mask), vld1q_u8(val), vld1q_u8(dst)));
+    }
+#endif
+    for (; n > 0; n--, dst++, val++, mask++) {
+        if (*mask) *dst = *val;
+    }
+}
+
+void compose(const frame_s &frame, const Uint8 *pOverlay, int iOverlayPitch,
+             int iOverlayW, int iOverlayH, int iSrcW, int iSrcH,
+             const palette::t_yuv_color *pPalette, unsigned int uColors)
+{
+    int iW = frame.iWidth, iH = frame.iHeight;
+    if ((iW < 2) || (iH < 2) || (iSrcW <= 0) || (iSrcH <= 0) || !pPalette) return;
+
+    // the palette, split up so each plane is a straight lookup
+    Uint8 lutY[256], lutU[256], lutV[256], lutA[256];
+    for (unsigned int i = 0; i < 256; i++) {
+        bool bVisible = (i < uColors) && !pPalette[i].transparent;
+        lutA[i]       = bVisible ? 0xFF : 0;
+        lutY[i]       = bVisible ? pPalette[i].y : 0;
+        lutU[i]       = bVisible ? pPalette[i].u : 0;
+        lutV[i]       = bVisible ? pPalette[i].v : 0;
+    }
+
+    g_xmap.resize(iW);
+    for (int x = 0; x < iW; x++) {
+        int ox    = (int)(((Sint64)x * iSrcW) / iW);
+        g_xmap[x] = (ox < iOverlayW) ? ox : -1;
+    }
+
+    // most of an overlay is usually see-through
+    int iRows = (iOverlayH < iSrcH) ? iOverlayH : iSrcH;
+    int iCols = (iOverlayW < iSrcW) ? iOverlayW : iSrcW;
+    g_row_visible.assign(iRows, 0);
+    for (int oy = 0; oy < iRows; oy++) {
+        const Uint8 *s = pOverlay + oy * iOverlayPitch;
+        for (int ox = 0; ox < iCols; ox++) {
+            if (lutA[s[ox]]) {
+                g_row_visible[oy] = 1;
+                break;
+            }
+        }
+    }
+
+    g_val.resize(iW);
+    g_val2.resize(iW);
+    g_mask.resize(iW);
+
+    for (int y = 0; y < iH; y++) {
+        int oy = (int)(((Sint64)y * iSrcH) / iH);
+        if ((oy >= iRows) || !g_row_visible[oy]) continue;
+
+        const Uint8 *s = pOverlay + oy * iOverlayPitch;
+        for (int x = 0; x < iW; x++) {
+            int ox = g_xmap[x];
+            Uint8 p = (ox < 0) ? 0 : s[ox];
+            g_val[x]  = lutY[p];
+            g_mask[x] = (ox < 0) ? 0 : lutA[p];
+        }
+        select_span(frame.pY + y * frame.iYPitch, &g_val[0], &g_mask[0], iW);
+    }
+
+    // each chroma sample takes the overlay pixel over its top left luma pixel
+    int iCW = iW >> 1, iCH = iH >> 1;
+    for (int cy = 0; cy < iCH; cy++) {
+        int oy = (int)(((Sint64)(cy << 1) * iSrcH) / iH);
+        if ((oy >= iRows) || !g_row_visible[oy]) continue;
+
+        const Uint8 *s = pOverlay + oy * iOverlayPitch;
+        for (int cx = 0; cx < iCW; cx++) {
+            int ox = g_xmap[cx << 1];
+            Uint8 p = (ox < 0) ? 0 : s[ox];
+            g_val[cx]  = lutU[p];
+            g_val2[cx] = lutV[p];
+            g_mask[cx] = (ox < 0) ? 0 : lutA[p];
+        }
+        select_span(frame.pU + cy * frame.iUPitch, &g_val[0], &g_mask[0], iCW);
+        select_span(frame.pV + cy * frame.iVPitch, &g_val2[0], &g_mask[0], iCW);
+    }
+}
+}
@@ -0,0 +1,52 @@
+/*
+ * ____ DAPHNE COPYRIGHT NOTICE ____
+ *
+ * This file is part of DAPHNE, a laserdisc arcade game emulator
+ *
+ * DAPHNE is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * DAPHNE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// yuvblend.h
+// Lays the 8-bit game overlay over the disc video while it is still YV12
+// (-yuv_compose), so the renderer gets one texture to draw instead of
+// converting the video to RGB and then blending an RGBA overlay over it.
+
+#ifndef YUVBLEND_H
+#define YUVBLEND_H
+
+#include "palette.h"
+#include <SDL.h>
+
+namespace yuvblend
+{
+// a YV12 frame: full size Y plane, U and V at half size in both directions
+struct frame_s {
+    Uint8 *pY, *pU, *pV;
+    int iWidth, iHeight;
+    int iYPitch, iUPitch, iVPitch;
+};
+
+// Draws the overlay onto 'frame'.
+// The top left iSrcW x iSrcH of the overlay is stretched (nearest neighbour)
+// over the whole frame, the same way the renderer stretches the overlay
+// texture over the video.  Parts of that area beyond the overlay's own
+// iOverlayW x iOverlayH are transparent, as are the colors 'pPalette' marks
+// transparent and any index at or past uColors.
+void compose(const frame_s &frame, const Uint8 *pOverlay, int iOverlayPitch,
+             int iOverlayW, int iOverlayH, int iSrcW, int iSrcH,
+             const palette::t_yuv_color *pPalette, unsigned int uColors);
+}
+
+#endif